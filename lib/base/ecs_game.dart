@@ -27,10 +27,18 @@ abstract class ECSGame extends Game {
 
   double _dt = 0;
 
+  /// Fixed time step used by [physicsWorld].
+  static const double physicsTimeStepSeconds = 1 / 60;
+
   @override
   void start() {
     enableFixedUpdate = false;
 
+    // Step physics at a fixed rate regardless of the frame rate and render
+    // interpolated transforms in between.
+    physicsWorld.stepSettings = phys.StepSettings()
+      ..fixedTimeStep = physicsTimeStepSeconds;
+
     _world.registerComponent(() => TransformComponent());
     _world.registerComponent(() => CameraComponent());
     _world.registerComponent(() => MeshComponent());
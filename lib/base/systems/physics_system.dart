@@ -11,9 +11,16 @@ class PhysicsSystem extends oxy.System {
   phys.World physicsWorld;
 
   late oxy.Query rigidBodySyncQuery;
+  late phys.TransformMirror transformMirror;
+  late phys.ActivationEvents activationEvents;
+
+  // Sleeping bodies whose final transform has been written to their entity.
+  final Expando<bool> _settled = Expando<bool>();
 
   @override
   void init() {
+    transformMirror = physicsWorld.enableTransformMirror(matrices: true);
+    activationEvents = physicsWorld.enableActivationEvents();
     rigidBodySyncQuery = createQuery([
       oxy.Has<RigidBodyComponent>(),
       oxy.Has<TransformComponent>(),
@@ -23,12 +30,23 @@ class PhysicsSystem extends oxy.System {
   @override
   void execute(double delta) {
     physicsWorld.step(delta);
+    final alpha = physicsWorld.interpolationAlpha;
+    for (final body in activationEvents.deactivated) {
+      _settled[body] = null;
+    }
 
-    // When a RigidBody is attached, drive the Entity's transform.
+    // When a RigidBody is attached, drive the Entity's transform. Sleeping
+    // bodies don't move so they are written once when they fall asleep.
     for (final entity in rigidBodySyncQuery.entities) {
-      final transform = entity.get<TransformComponent>()!;
       final rigidBody = entity.get<RigidBodyComponent>()!.rigidBody!;
-      transform.matrix = rigidBody.worldTransform;
+      if (activationEvents.isActive(rigidBody)) {
+        final transform = entity.get<TransformComponent>()!;
+        transformMirror.interpolatedMatrix(rigidBody, alpha, transform.matrix);
+      } else if (_settled[rigidBody] == null) {
+        final transform = entity.get<TransformComponent>()!;
+        transformMirror.matrix(rigidBody, transform.matrix);
+        _settled[rigidBody] = true;
+      }
     }
   }
 }
@@ -154,15 +154,17 @@ class CabalGame extends ECSGame {
             phys.BodySettings(floorPlane)..motionType = phys.MotionType.static);
         world.createEntity().add<RigidBodyComponent, phys.RigidBody>(floor);
         const int wallSize = 5;
-        for (int i = 0; i < wallSize; i++) {
-          for (int j = 0; j < wallSize; j++) {
-            const double size = 1.15;
-            const double x = 0;
-            final double y = j * size + 1.2;
-            final double z = i * size;
-            boxSpawner.spawnBox(world!, physicsWorld, vm.Vector3(x, y, z));
+        physicsWorld.batchAdd(() {
+          for (int i = 0; i < wallSize; i++) {
+            for (int j = 0; j < wallSize; j++) {
+              const double size = 1.15;
+              const double x = 0;
+              final double y = j * size + 1.2;
+              final double z = i * size;
+              boxSpawner.spawnBox(world!, physicsWorld, vm.Vector3(x, y, z));
+            }
           }
-        }
+        });
       case SceneType.pyramid:
         //--------------------------------------------------------------------------
         /// Create static floor and pyramid.
@@ -174,16 +176,18 @@ class CabalGame extends ECSGame {
         world.createEntity().add<RigidBodyComponent, phys.RigidBody>(floor);
 
         const int pyramidHeight = 5;
-        for (int i = 0; i < pyramidHeight; i++) {
-          for (var j = i; j < pyramidHeight - 1; j++) {
-            const double size = 1.15;
-            const double x = 0;
-            final double y = (pyramidHeight - j) * size + 1.2 - 2.0;
-            final double z = i * size;
-            boxSpawner.spawnBox(world!, physicsWorld, vm.Vector3(x, y, z));
-            boxSpawner.spawnBox(world!, physicsWorld, vm.Vector3(x, y, -z));
+        physicsWorld.batchAdd(() {
+          for (int i = 0; i < pyramidHeight; i++) {
+            for (var j = i; j < pyramidHeight - 1; j++) {
+              const double size = 1.15;
+              const double x = 0;
+              final double y = (pyramidHeight - j) * size + 1.2 - 2.0;
+              final double z = i * size;
+              boxSpawner.spawnBox(world!, physicsWorld, vm.Vector3(x, y, z));
+              boxSpawner.spawnBox(world!, physicsWorld, vm.Vector3(x, y, -z));
+            }
           }
-        }
+        });
     }
   }
 }
@@ -1,4 +1,6 @@
+import 'dart:async';
 import 'dart:ffi' as ffi;
+import 'dart:isolate';
 import 'dart:typed_data';
 import 'dart:collection';
 import 'package:cabal/physics/src/jolt_ffi_generated.dart';
@@ -12,5 +14,10 @@ import 'src/jolt_ffi.dart' as jolt;
 part 'src/world.dart';
 part 'src/body.dart';
 part 'src/shape.dart';
+part 'src/shape_bundle.dart';
 part 'src/query.dart';
 part 'src/util.dart';
+part 'src/transform_mirror.dart';
+part 'src/contact_events.dart';
+part 'src/activation_events.dart';
+part 'src/sensor_events.dart';
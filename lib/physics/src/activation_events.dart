@@ -0,0 +1,44 @@
+part of '../physics.dart';
+
+/// Tracks which bodies in a [World] are awake.
+///
+/// The native world keeps a bitmap of active bodies and, for every
+/// [World.step], the bodies that woke up or fell asleep. Sleeping bodies don't
+/// move so callers that mirror transforms can skip them.
+class ActivationEvents {
+  final World _world;
+  final ffi.Pointer<jolt.ActivationEvents> _native;
+  final Uint64List _activeBits;
+
+  ActivationEvents._(this._world, this._native)
+      : _activeBits =
+            _native.ref.active_bits.asTypedList(_native.ref.num_words);
+
+  // Returns true if body is in the world and awake.
+  bool isActive(Body body) {
+    final index = body._index;
+    return (_activeBits[index >> 6] & (1 << (index & 63))) != 0;
+  }
+
+  // Bodies that woke up during the last step.
+  List<Body> get activated {
+    return _bodies(_native.ref.activated, _native.ref.num_activated);
+  }
+
+  // Bodies that fell asleep during the last step. Their transforms are final
+  // until they are activated again.
+  List<Body> get deactivated {
+    return _bodies(_native.ref.deactivated, _native.ref.num_deactivated);
+  }
+
+  List<Body> _bodies(ffi.Pointer<ffi.Uint32> indices, int count) {
+    final bodies = <Body>[];
+    for (int i = 0; i < count; i++) {
+      final body = _world._bodyAtIndex(indices[i]);
+      if (body != null) {
+        bodies.add(body);
+      }
+    }
+    return bodies;
+  }
+}
@@ -31,12 +31,16 @@ class BodySettings {
   Quaternion? rotation;
   MotionType motionType = MotionType.static;
   MotionQuality motionQuality = MotionQuality.discrete;
+  // Sensors detect overlapping moving bodies instead of colliding with them.
+  // See [World.enableSensorEvents].
+  bool isSensor = false;
 
   BodySettings(this.shape);
 
   _copyToConfig(ffi.Pointer<jolt.BodyConfig> config) {
     config.ref.motion_type = motionType.index;
     config.ref.motion_quality = motionQuality.index;
+    config.ref.is_sensor = isSensor;
     config.ref.shape = ffi.Pointer<jolt.CollisionShape>.fromAddress(
         shape._nativeShape.address);
     if (position != null) {
@@ -73,6 +77,14 @@ class Body implements ffi.Finalizable {
   MotionType _motionType = MotionType.static;
   MotionQuality _motionQuality = MotionQuality.discrete;
 
+  late final int _index = jolt.bindings.body_get_index(_nativeBody);
+
+  // Slot in the world's TransformMirror while the body is added to a world.
+  int _mirrorSlot = -1;
+
+  final Matrix4 _syncedWorldTransform = Matrix4.identity();
+  bool _syncedWorldTransformDirty = true;
+
   final unwrappedPositionSetter = jolt.dylib.lookupFunction<
       ffi.Void Function(ffi.Pointer<jolt.WorldBody>, ffi.Pointer<ffi.Float>),
       void Function(ffi.Pointer<jolt.WorldBody>,
@@ -85,6 +97,7 @@ class Body implements ffi.Finalizable {
     p[2] = position.z;
     unwrappedPositionSetter(_nativeBody, p);
     calloc.free(p);
+    _syncedWorldTransformDirty = true;
   }
 
   static final unwrappedPositionGetter = jolt.dylib.lookupFunction<
@@ -115,6 +128,7 @@ class Body implements ffi.Finalizable {
     p[3] = rotation.w;
     unwrappedRotationSetter(_nativeBody, p);
     calloc.free(p);
+    _syncedWorldTransformDirty = true;
   }
 
   static final unwrappedRotationGetter = jolt.dylib.lookupFunction<
@@ -163,6 +177,17 @@ class Body implements ffi.Finalizable {
     return m;
   }
 
+  // World transform as of the last [World.syncActiveTransforms]. Bodies that
+  // were not active keep their previous transform. The returned matrix is
+  // updated in place.
+  Matrix4 get syncedWorldTransform {
+    if (_syncedWorldTransformDirty) {
+      _syncedWorldTransform.setFrom(worldTransform);
+      _syncedWorldTransformDirty = false;
+    }
+    return _syncedWorldTransform;
+  }
+
   static final unwrapperCenterOfMassTransformGetter = jolt.dylib.lookupFunction<
       ffi.Void Function(ffi.Pointer<jolt.WorldBody>, ffi.Pointer<ffi.Float>),
       void Function(ffi.Pointer<jolt.WorldBody>,
@@ -230,6 +255,13 @@ class Body implements ffi.Finalizable {
     jolt.bindings.body_set_active(_nativeBody, activate);
   }
 
+  // Setting this to true records contacts involving this body in
+  // [World.enableContactEvents].
+  set contactEvents(bool enabled) {
+    _world._checkNotStepping();
+    jolt.bindings.body_set_contact_events(_nativeBody, enabled);
+  }
+
   Body._(this._world, this._nativeBody, this._shape) {
     _finalizer.attach(this, _nativeBody.cast(), detach: this);
     jolt.bindings.set_body_dart_owner(_nativeBody, this);
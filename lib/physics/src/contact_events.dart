@@ -0,0 +1,60 @@
+part of '../physics.dart';
+
+enum ContactEventType { added, persisted, removed }
+
+class ContactEvent {
+  final ContactEventType type;
+  // Either body can be null if it was removed from the world since the step.
+  final Body? body1;
+  final Body? body2;
+  final int subShapeId1;
+  final int subShapeId2;
+  // World space contact point on body1. Zero for removed contacts.
+  final Vector3 point;
+  // Contact normal pointing from body1 to body2. Zero for removed contacts.
+  final Vector3 normal;
+  // Estimated impulse needed to stop the bodies from approaching each other.
+  final double impulse;
+
+  ContactEvent._(this.type, this.body1, this.body2, this.subShapeId1,
+      this.subShapeId2, this.point, this.normal, this.impulse);
+}
+
+/// Contact events recorded during the most recent [World.step].
+///
+/// The native world appends events into a fixed size buffer while stepping,
+/// so reading them costs no native calls. Only pairs where at least one body
+/// has [Body.contactEvents] set are recorded.
+class ContactEvents {
+  final World _world;
+  final ffi.Pointer<jolt.ContactEventBuffer> _native;
+
+  ContactEvents._(this._world, this._native);
+
+  int get capacity {
+    return _native.ref.capacity;
+  }
+
+  int get length {
+    return _native.ref.count;
+  }
+
+  // Number of events from the last step that didn't fit in the buffer.
+  int get dropped {
+    return _native.ref.dropped;
+  }
+
+  ContactEvent operator [](int index) {
+    RangeError.checkValidIndex(index, this, 'index', length);
+    final event = _native.ref.events[index];
+    return ContactEvent._(
+        ContactEventType.values[event.type],
+        _world._bodyAtIndex(event.body_index1),
+        _world._bodyAtIndex(event.body_index2),
+        event.sub_shape_id1,
+        event.sub_shape_id2,
+        Vector3(event.point[0], event.point[1], event.point[2]),
+        Vector3(event.normal[0], event.normal[1], event.normal[2]),
+        event.impulse);
+  }
+}
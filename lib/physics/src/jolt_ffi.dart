@@ -4,13 +4,34 @@ import 'jolt_ffi_generated.dart';
 export 'jolt_ffi_generated.dart'
     show
         World,
+        WorldConfig,
+        StepConfig,
         CollisionShape,
         WorldBody,
         BodyConfig,
         ConvexShapeConfig,
         ConvexShapeConfigType,
         CompoundShapeConfig,
+        MeshIndexType,
+        MeshInput,
+        DecompositionConfig,
+        ShapeCacheStats,
+        ShapeBundle,
+        ShapeBundleStats,
         RayCastConfig,
+        RayCastFlags,
+        Ray,
+        RayCastMode,
+        RayCastHit,
+        ContactEventType,
+        ContactEvent,
+        ContactEventBuffer,
+        ActivationEvents,
+        SensorEventType,
+        SensorEvent,
+        SensorEvents,
+        BodyTransform,
+        TransformMirror,
         DecoratedShapeConfigType,
         DecoratedShapeConfig;
 
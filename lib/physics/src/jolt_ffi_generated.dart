@@ -431,16 +431,77 @@ class Jolt {
   late final _native_free =
       _native_freePtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
 
+  /// Shared job system.
+  /// Sets the size and thread priority of the process wide worker pool used by
+  /// worlds with num_threads -1 and by the async shape functions. num_threads -1
+  /// uses one thread less than the number of hardware threads and the pool
+  /// always keeps at least one. Only applies before the pool is first used,
+  /// returns false and changes nothing once it is running.
+  bool job_system_configure(
+    int num_threads,
+    int priority,
+  ) {
+    return _job_system_configure(
+      num_threads,
+      priority,
+    );
+  }
+
+  late final _job_system_configurePtr =
+      _lookup<ffi.NativeFunction<ffi.Bool Function(ffi.Int, ffi.Int)>>(
+          'job_system_configure');
+  late final _job_system_configure =
+      _job_system_configurePtr.asFunction<bool Function(int, int)>();
+
+  /// Runs task(data) on the shared pool. Matches the executor signature expected
+  /// by convex_hull_set_executor so decomposition jobs can share the pool.
+  void job_system_run_task(
+    JobTask task,
+    ffi.Pointer<ffi.Void> data,
+  ) {
+    return _job_system_run_task(
+      task,
+      data,
+    );
+  }
+
+  late final _job_system_run_taskPtr = _lookup<
+          ffi.NativeFunction<
+              ffi.Void Function(JobTask, ffi.Pointer<ffi.Void>)>>(
+      'job_system_run_task');
+  late final _job_system_run_task = _job_system_run_taskPtr
+      .asFunction<void Function(JobTask, ffi.Pointer<ffi.Void>)>();
+
   /// World.
-  ffi.Pointer<World> create_world() {
-    return _create_world();
+  void world_config_init_defaults(
+    ffi.Pointer<WorldConfig> config,
+  ) {
+    return _world_config_init_defaults(
+      config,
+    );
+  }
+
+  late final _world_config_init_defaultsPtr = _lookup<
+          ffi.NativeFunction<ffi.Void Function(ffi.Pointer<WorldConfig>)>>(
+      'world_config_init_defaults');
+  late final _world_config_init_defaults = _world_config_init_defaultsPtr
+      .asFunction<void Function(ffi.Pointer<WorldConfig>)>();
+
+  /// config may be null to use the defaults.
+  ffi.Pointer<World> create_world(
+    ffi.Pointer<WorldConfig> config,
+  ) {
+    return _create_world(
+      config,
+    );
   }
 
-  late final _create_worldPtr =
-      _lookup<ffi.NativeFunction<ffi.Pointer<World> Function()>>(
-          'create_world');
-  late final _create_world =
-      _create_worldPtr.asFunction<ffi.Pointer<World> Function()>();
+  late final _create_worldPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<World> Function(
+              ffi.Pointer<WorldConfig>)>>('create_world');
+  late final _create_world = _create_worldPtr
+      .asFunction<ffi.Pointer<World> Function(ffi.Pointer<WorldConfig>)>();
 
   ffi.Pointer<WorldBody> world_create_body(
     ffi.Pointer<World> world,
@@ -496,6 +557,134 @@ class Jolt {
   late final _world_remove_body = _world_remove_bodyPtr
       .asFunction<void Function(ffi.Pointer<World>, ffi.Pointer<WorldBody>)>();
 
+  void world_create_bodies(
+    ffi.Pointer<World> world,
+    ffi.Pointer<BodyConfig> configs,
+    int num_bodies,
+    ffi.Pointer<ffi.Pointer<WorldBody>> out,
+  ) {
+    return _world_create_bodies(
+      world,
+      configs,
+      num_bodies,
+      out,
+    );
+  }
+
+  late final _world_create_bodiesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<World>,
+              ffi.Pointer<BodyConfig>,
+              ffi.Int,
+              ffi.Pointer<ffi.Pointer<WorldBody>>)>>('world_create_bodies');
+  late final _world_create_bodies = _world_create_bodiesPtr.asFunction<
+      void Function(ffi.Pointer<World>,
+          ffi.Pointer<BodyConfig>,
+          int,
+          ffi.Pointer<ffi.Pointer<WorldBody>>)>();
+
+  void world_add_bodies(
+    ffi.Pointer<World> world,
+    ffi.Pointer<ffi.Pointer<WorldBody>> bodies,
+    int num_bodies,
+    int activation,
+  ) {
+    return _world_add_bodies(
+      world,
+      bodies,
+      num_bodies,
+      activation,
+    );
+  }
+
+  late final _world_add_bodiesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<World>,
+              ffi.Pointer<ffi.Pointer<WorldBody>>,
+              ffi.Int,
+              ffi.Int)>>('world_add_bodies');
+  late final _world_add_bodies = _world_add_bodiesPtr.asFunction<
+      void Function(ffi.Pointer<World>,
+          ffi.Pointer<ffi.Pointer<WorldBody>>,
+          int,
+          int)>();
+
+  ffi.Pointer<BodyBatch> world_add_bodies_prepare(
+    ffi.Pointer<World> world,
+    ffi.Pointer<ffi.Pointer<WorldBody>> bodies,
+    int num_bodies,
+  ) {
+    return _world_add_bodies_prepare(
+      world,
+      bodies,
+      num_bodies,
+    );
+  }
+
+  late final _world_add_bodies_preparePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<BodyBatch> Function(ffi.Pointer<World>,
+              ffi.Pointer<ffi.Pointer<WorldBody>>,
+              ffi.Int)>>('world_add_bodies_prepare');
+  late final _world_add_bodies_prepare = _world_add_bodies_preparePtr.asFunction<
+      ffi.Pointer<BodyBatch> Function(ffi.Pointer<World>,
+          ffi.Pointer<ffi.Pointer<WorldBody>>,
+          int)>();
+
+  void world_add_bodies_finalize(
+    ffi.Pointer<World> world,
+    ffi.Pointer<BodyBatch> batch,
+    int activation,
+  ) {
+    return _world_add_bodies_finalize(
+      world,
+      batch,
+      activation,
+    );
+  }
+
+  late final _world_add_bodies_finalizePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<World>,
+              ffi.Pointer<BodyBatch>,
+              ffi.Int)>>('world_add_bodies_finalize');
+  late final _world_add_bodies_finalize = _world_add_bodies_finalizePtr.asFunction<
+      void Function(ffi.Pointer<World>, ffi.Pointer<BodyBatch>, int)>();
+
+  void world_add_bodies_abort(
+    ffi.Pointer<World> world,
+    ffi.Pointer<BodyBatch> batch,
+  ) {
+    return _world_add_bodies_abort(
+      world,
+      batch,
+    );
+  }
+
+  late final _world_add_bodies_abortPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<World>, ffi.Pointer<BodyBatch>)>>('world_add_bodies_abort');
+  late final _world_add_bodies_abort = _world_add_bodies_abortPtr.asFunction<
+      void Function(ffi.Pointer<World>, ffi.Pointer<BodyBatch>)>();
+
+  ffi.Pointer<TransformMirror> world_enable_transform_mirror(
+    ffi.Pointer<World> world,
+    int capacity,
+    bool matrices,
+  ) {
+    return _world_enable_transform_mirror(
+      world,
+      capacity,
+      matrices,
+    );
+  }
+
+  late final _world_enable_transform_mirrorPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<TransformMirror> Function(ffi.Pointer<World>, ffi.Int, ffi.Bool)>>('world_enable_transform_mirror');
+  late final _world_enable_transform_mirror = _world_enable_transform_mirrorPtr.asFunction<
+      ffi.Pointer<TransformMirror> Function(ffi.Pointer<World>, int, bool)>();
+
   int world_step(
     ffi.Pointer<World> world,
     double dt,
@@ -512,6 +701,148 @@ class Jolt {
   late final _world_step =
       _world_stepPtr.asFunction<int Function(ffi.Pointer<World>, double)>();
 
+  void world_set_step_config(
+    ffi.Pointer<World> world,
+    ffi.Pointer<StepConfig> config,
+  ) {
+    return _world_set_step_config(
+      world,
+      config,
+    );
+  }
+
+  late final _world_set_step_configPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<World>, ffi.Pointer<StepConfig>)>>('world_set_step_config');
+  late final _world_set_step_config = _world_set_step_configPtr.asFunction<
+      void Function(ffi.Pointer<World>, ffi.Pointer<StepConfig>)>();
+
+  double world_get_interpolation_alpha(
+    ffi.Pointer<World> world,
+  ) {
+    return _world_get_interpolation_alpha(
+      world,
+    );
+  }
+
+  late final _world_get_interpolation_alphaPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Float Function(ffi.Pointer<World>)>>('world_get_interpolation_alpha');
+  late final _world_get_interpolation_alpha = _world_get_interpolation_alphaPtr.asFunction<
+      double Function(ffi.Pointer<World>)>(isLeaf: true);
+
+  bool world_step_async(
+    ffi.Pointer<World> world,
+    double dt,
+    int port,
+  ) {
+    return _world_step_async(
+      world,
+      dt,
+      port,
+    );
+  }
+
+  late final _world_step_asyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<World>, ffi.Float, Dart_Port_DL)>>('world_step_async');
+  late final _world_step_async = _world_step_asyncPtr.asFunction<
+      bool Function(ffi.Pointer<World>, double, int)>();
+
+  int world_step_wait(
+    ffi.Pointer<World> world,
+  ) {
+    return _world_step_wait(
+      world,
+    );
+  }
+
+  late final _world_step_waitPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<World>)>>('world_step_wait');
+  late final _world_step_wait = _world_step_waitPtr.asFunction<
+      int Function(ffi.Pointer<World>)>();
+
+  bool world_step_poll(
+    ffi.Pointer<World> world,
+  ) {
+    return _world_step_poll(
+      world,
+    );
+  }
+
+  late final _world_step_pollPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<World>)>>('world_step_poll');
+  late final _world_step_poll = _world_step_pollPtr.asFunction<
+      bool Function(ffi.Pointer<World>)>(isLeaf: true);
+
+  ffi.Pointer<ContactEventBuffer> world_enable_contact_events(
+    ffi.Pointer<World> world,
+    int capacity,
+  ) {
+    return _world_enable_contact_events(
+      world,
+      capacity,
+    );
+  }
+
+  late final _world_enable_contact_eventsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ContactEventBuffer> Function(ffi.Pointer<World>, ffi.Int)>>('world_enable_contact_events');
+  late final _world_enable_contact_events = _world_enable_contact_eventsPtr.asFunction<
+      ffi.Pointer<ContactEventBuffer> Function(ffi.Pointer<World>, int)>();
+
+  ffi.Pointer<ActivationEvents> world_enable_activation_events(
+    ffi.Pointer<World> world,
+  ) {
+    return _world_enable_activation_events(
+      world,
+    );
+  }
+
+  late final _world_enable_activation_eventsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ActivationEvents> Function(ffi.Pointer<World>)>>('world_enable_activation_events');
+  late final _world_enable_activation_events = _world_enable_activation_eventsPtr.asFunction<
+      ffi.Pointer<ActivationEvents> Function(ffi.Pointer<World>)>();
+
+  ffi.Pointer<SensorEvents> world_enable_sensor_events(
+    ffi.Pointer<World> world,
+  ) {
+    return _world_enable_sensor_events(
+      world,
+    );
+  }
+
+  late final _world_enable_sensor_eventsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<SensorEvents> Function(ffi.Pointer<World>)>>('world_enable_sensor_events');
+  late final _world_enable_sensor_events = _world_enable_sensor_eventsPtr.asFunction<
+      ffi.Pointer<SensorEvents> Function(ffi.Pointer<World>)>();
+
+  int world_get_active_transforms(
+    ffi.Pointer<World> world,
+    ffi.Pointer<BodyTransform> out,
+    int max_transforms,
+  ) {
+    return _world_get_active_transforms(
+      world,
+      out,
+      max_transforms,
+    );
+  }
+
+  late final _world_get_active_transformsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<World>,
+              ffi.Pointer<BodyTransform>,
+              ffi.Int)>>('world_get_active_transforms');
+  late final _world_get_active_transforms = _world_get_active_transformsPtr.asFunction<
+      int Function(ffi.Pointer<World>,
+          ffi.Pointer<BodyTransform>,
+          int)>(isLeaf: true);
+
   void world_raycast(
     ffi.Pointer<World> world,
     ffi.Pointer<RayCastConfig> config,
@@ -529,6 +860,36 @@ class Jolt {
   late final _world_raycast = _world_raycastPtr.asFunction<
       void Function(ffi.Pointer<World>, ffi.Pointer<RayCastConfig>)>();
 
+  void world_raycast_batch(
+    ffi.Pointer<World> world,
+    ffi.Pointer<Ray> rays,
+    int num_rays,
+    ffi.Pointer<RayCastHit> out,
+    int mode,
+  ) {
+    return _world_raycast_batch(
+      world,
+      rays,
+      num_rays,
+      out,
+      mode,
+    );
+  }
+
+  late final _world_raycast_batchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<World>,
+              ffi.Pointer<Ray>,
+              ffi.Int,
+              ffi.Pointer<RayCastHit>,
+              ffi.Int)>>('world_raycast_batch');
+  late final _world_raycast_batch = _world_raycast_batchPtr.asFunction<
+      void Function(ffi.Pointer<World>,
+          ffi.Pointer<Ray>,
+          int,
+          ffi.Pointer<RayCastHit>,
+          int)>();
+
   void destroy_world(
     ffi.Pointer<World> world,
   ) {
@@ -603,6 +964,106 @@ class Jolt {
       ffi.Pointer<CollisionShape> Function(
           ffi.Pointer<ffi.Float>, int, ffi.Pointer<ffi.Uint32>, int)>();
 
+  ffi.Pointer<CollisionShape> create_convex_shape_strided(
+    ffi.Pointer<ConvexShapeConfig> config,
+    ffi.Pointer<MeshInput> points,
+  ) {
+    return _create_convex_shape_strided(
+      config,
+      points,
+    );
+  }
+
+  late final _create_convex_shape_stridedPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+              ffi.Pointer<MeshInput>)>>('create_convex_shape_strided');
+  late final _create_convex_shape_strided = _create_convex_shape_stridedPtr.asFunction<
+      ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+          ffi.Pointer<MeshInput>)>();
+
+  ffi.Pointer<CollisionShape> create_mesh_shape_strided(
+    ffi.Pointer<MeshInput> input,
+  ) {
+    return _create_mesh_shape_strided(
+      input,
+    );
+  }
+
+  late final _create_mesh_shape_stridedPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<CollisionShape> Function(ffi.Pointer<MeshInput>)>>('create_mesh_shape_strided');
+  late final _create_mesh_shape_strided = _create_mesh_shape_stridedPtr.asFunction<
+      ffi.Pointer<CollisionShape> Function(ffi.Pointer<MeshInput>)>();
+
+  ffi.Pointer<CollisionShape> create_convex_shape_strided_flat(
+    ffi.Pointer<ConvexShapeConfig> config,
+    ffi.Pointer<ffi.Uint8> vertices,
+    int num_vertices,
+    int vertex_stride,
+    int position_offset,
+  ) {
+    return _create_convex_shape_strided_flat(
+      config,
+      vertices,
+      num_vertices,
+      vertex_stride,
+      position_offset,
+    );
+  }
+
+  late final _create_convex_shape_strided_flatPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int)>>('create_convex_shape_strided_flat');
+  late final _create_convex_shape_strided_flat = _create_convex_shape_strided_flatPtr.asFunction<
+      ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+          int,
+          int)>();
+
+  ffi.Pointer<CollisionShape> create_mesh_shape_strided_flat(
+    ffi.Pointer<ffi.Uint8> vertices,
+    int num_vertices,
+    int vertex_stride,
+    int position_offset,
+    ffi.Pointer<ffi.Uint8> indices,
+    int num_triangles,
+    int index_type,
+  ) {
+    return _create_mesh_shape_strided_flat(
+      vertices,
+      num_vertices,
+      vertex_stride,
+      position_offset,
+      indices,
+      num_triangles,
+      index_type,
+    );
+  }
+
+  late final _create_mesh_shape_strided_flatPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<CollisionShape> Function(ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int)>>('create_mesh_shape_strided_flat');
+  late final _create_mesh_shape_strided_flat = _create_mesh_shape_strided_flatPtr.asFunction<
+      ffi.Pointer<CollisionShape> Function(ffi.Pointer<ffi.Uint8>,
+          int,
+          int,
+          int,
+          ffi.Pointer<ffi.Uint8>,
+          int,
+          int)>();
+
   ffi.Pointer<CollisionShape> create_decorated_shape(
     ffi.Pointer<DecoratedShapeConfig> config,
   ) {
@@ -619,6 +1080,173 @@ class Jolt {
       ffi.Pointer<CollisionShape> Function(
           ffi.Pointer<DecoratedShapeConfig>)>();
 
+  ffi.Pointer<CollisionShape> create_simplified_hull_shape(
+    ffi.Pointer<ConvexShapeConfig> config,
+    ffi.Pointer<MeshInput> points,
+    int max_vertices,
+  ) {
+    return _create_simplified_hull_shape(
+      config,
+      points,
+      max_vertices,
+    );
+  }
+
+  late final _create_simplified_hull_shapePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+              ffi.Pointer<MeshInput>,
+              ffi.Int)>>('create_simplified_hull_shape');
+  late final _create_simplified_hull_shape = _create_simplified_hull_shapePtr.asFunction<
+      ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+          ffi.Pointer<MeshInput>,
+          int)>();
+
+  ffi.Pointer<CollisionShape> create_decomposed_shape(
+    ffi.Pointer<MeshInput> mesh,
+    ffi.Pointer<DecompositionConfig> config,
+  ) {
+    return _create_decomposed_shape(
+      mesh,
+      config,
+    );
+  }
+
+  late final _create_decomposed_shapePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<CollisionShape> Function(ffi.Pointer<MeshInput>,
+              ffi.Pointer<DecompositionConfig>)>>('create_decomposed_shape');
+  late final _create_decomposed_shape = _create_decomposed_shapePtr.asFunction<
+      ffi.Pointer<CollisionShape> Function(ffi.Pointer<MeshInput>,
+          ffi.Pointer<DecompositionConfig>)>();
+
+  void create_convex_shape_async(
+    ffi.Pointer<ConvexShapeConfig> config,
+    ffi.Pointer<ffi.Float> points,
+    int num_points,
+    int port,
+    int request_id,
+  ) {
+    return _create_convex_shape_async(
+      config,
+      points,
+      num_points,
+      port,
+      request_id,
+    );
+  }
+
+  late final _create_convex_shape_asyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ConvexShapeConfig>,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int,
+              Dart_Port_DL,
+              ffi.Int64)>>('create_convex_shape_async');
+  late final _create_convex_shape_async = _create_convex_shape_asyncPtr.asFunction<
+      void Function(ffi.Pointer<ConvexShapeConfig>,
+          ffi.Pointer<ffi.Float>,
+          int,
+          int,
+          int)>();
+
+  void create_mesh_shape_async(
+    ffi.Pointer<ffi.Float> vertices,
+    int num_vertices,
+    ffi.Pointer<ffi.Uint32> triangles,
+    int num_triangles,
+    int port,
+    int request_id,
+  ) {
+    return _create_mesh_shape_async(
+      vertices,
+      num_vertices,
+      triangles,
+      num_triangles,
+      port,
+      request_id,
+    );
+  }
+
+  late final _create_mesh_shape_asyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Float>,
+              ffi.Int,
+              ffi.Pointer<ffi.Uint32>,
+              ffi.Int,
+              Dart_Port_DL,
+              ffi.Int64)>>('create_mesh_shape_async');
+  late final _create_mesh_shape_async = _create_mesh_shape_asyncPtr.asFunction<
+      void Function(ffi.Pointer<ffi.Float>,
+          int,
+          ffi.Pointer<ffi.Uint32>,
+          int,
+          int,
+          int)>();
+
+  void create_compound_shape_async(
+    ffi.Pointer<CompoundShapeConfig> shapes,
+    int num_shapes,
+    int port,
+    int request_id,
+  ) {
+    return _create_compound_shape_async(
+      shapes,
+      num_shapes,
+      port,
+      request_id,
+    );
+  }
+
+  late final _create_compound_shape_asyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<CompoundShapeConfig>,
+              ffi.Int,
+              Dart_Port_DL,
+              ffi.Int64)>>('create_compound_shape_async');
+  late final _create_compound_shape_async = _create_compound_shape_asyncPtr.asFunction<
+      void Function(ffi.Pointer<CompoundShapeConfig>, int, int, int)>();
+
+  void create_decomposed_shape_async(
+    ffi.Pointer<MeshInput> mesh,
+    ffi.Pointer<DecompositionConfig> config,
+    int port,
+    int request_id,
+  ) {
+    return _create_decomposed_shape_async(
+      mesh,
+      config,
+      port,
+      request_id,
+    );
+  }
+
+  late final _create_decomposed_shape_asyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<MeshInput>,
+              ffi.Pointer<DecompositionConfig>,
+              Dart_Port_DL,
+              ffi.Int64)>>('create_decomposed_shape_async');
+  late final _create_decomposed_shape_async = _create_decomposed_shape_asyncPtr.asFunction<
+      void Function(ffi.Pointer<MeshInput>,
+          ffi.Pointer<DecompositionConfig>,
+          int,
+          int)>();
+
+  void shape_cache_get_stats(
+    ffi.Pointer<ShapeCacheStats> stats,
+  ) {
+    return _shape_cache_get_stats(
+      stats,
+    );
+  }
+
+  late final _shape_cache_get_statsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ShapeCacheStats>)>>('shape_cache_get_stats');
+  late final _shape_cache_get_stats = _shape_cache_get_statsPtr.asFunction<
+      void Function(ffi.Pointer<ShapeCacheStats>)>(isLeaf: true);
+
   void shape_get_center_of_mass(
     ffi.Pointer<CollisionShape> shape,
     ffi.Pointer<ffi.Float> v3,
@@ -657,6 +1285,170 @@ class Jolt {
       void Function(ffi.Pointer<CollisionShape>, ffi.Pointer<ffi.Float>,
           ffi.Pointer<ffi.Float>)>();
 
+  int shape_get_num_hull_points(
+    ffi.Pointer<CollisionShape> shape,
+  ) {
+    return _shape_get_num_hull_points(
+      shape,
+    );
+  }
+
+  late final _shape_get_num_hull_pointsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<CollisionShape>)>>('shape_get_num_hull_points');
+  late final _shape_get_num_hull_points = _shape_get_num_hull_pointsPtr.asFunction<
+      int Function(ffi.Pointer<CollisionShape>)>();
+
+  int shape_get_num_sub_shapes(
+    ffi.Pointer<CollisionShape> shape,
+  ) {
+    return _shape_get_num_sub_shapes(
+      shape,
+    );
+  }
+
+  late final _shape_get_num_sub_shapesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<CollisionShape>)>>('shape_get_num_sub_shapes');
+  late final _shape_get_num_sub_shapes = _shape_get_num_sub_shapesPtr.asFunction<
+      int Function(ffi.Pointer<CollisionShape>)>();
+
+  ffi.Pointer<ffi.Uint8> shape_save_binary(
+    ffi.Pointer<CollisionShape> shape,
+    ffi.Pointer<ffi.Int> out_size,
+  ) {
+    return _shape_save_binary(
+      shape,
+      out_size,
+    );
+  }
+
+  late final _shape_save_binaryPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<CollisionShape>, ffi.Pointer<ffi.Int>)>>('shape_save_binary');
+  late final _shape_save_binary = _shape_save_binaryPtr.asFunction<
+      ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<CollisionShape>, ffi.Pointer<ffi.Int>)>();
+
+  ffi.Pointer<CollisionShape> shape_restore_binary(
+    ffi.Pointer<ffi.Uint8> data,
+    int size,
+  ) {
+    return _shape_restore_binary(
+      data,
+      size,
+    );
+  }
+
+  late final _shape_restore_binaryPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<CollisionShape> Function(ffi.Pointer<ffi.Uint8>, ffi.Size)>>('shape_restore_binary');
+  late final _shape_restore_binary = _shape_restore_binaryPtr.asFunction<
+      ffi.Pointer<CollisionShape> Function(ffi.Pointer<ffi.Uint8>, int)>();
+
+  bool shape_bundle_write(
+    ffi.Pointer<ffi.Char> path,
+    ffi.Pointer<ffi.Pointer<CollisionShape>> shapes,
+    ffi.Pointer<ffi.Pointer<ffi.Char>> names,
+    int num_shapes,
+  ) {
+    return _shape_bundle_write(
+      path,
+      shapes,
+      names,
+      num_shapes,
+    );
+  }
+
+  late final _shape_bundle_writePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Bool Function(ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Pointer<CollisionShape>>,
+              ffi.Pointer<ffi.Pointer<ffi.Char>>,
+              ffi.Int)>>('shape_bundle_write');
+  late final _shape_bundle_write = _shape_bundle_writePtr.asFunction<
+      bool Function(ffi.Pointer<ffi.Char>,
+          ffi.Pointer<ffi.Pointer<CollisionShape>>,
+          ffi.Pointer<ffi.Pointer<ffi.Char>>,
+          int)>();
+
+  ffi.Pointer<ShapeBundle> shape_bundle_open(
+    ffi.Pointer<ffi.Char> path,
+  ) {
+    return _shape_bundle_open(
+      path,
+    );
+  }
+
+  late final _shape_bundle_openPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ShapeBundle> Function(ffi.Pointer<ffi.Char>)>>('shape_bundle_open');
+  late final _shape_bundle_open = _shape_bundle_openPtr.asFunction<
+      ffi.Pointer<ShapeBundle> Function(ffi.Pointer<ffi.Char>)>();
+
+  int shape_bundle_find(
+    ffi.Pointer<ShapeBundle> bundle,
+    ffi.Pointer<ffi.Char> name,
+  ) {
+    return _shape_bundle_find(
+      bundle,
+      name,
+    );
+  }
+
+  late final _shape_bundle_findPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ShapeBundle>, ffi.Pointer<ffi.Char>)>>('shape_bundle_find');
+  late final _shape_bundle_find = _shape_bundle_findPtr.asFunction<
+      int Function(ffi.Pointer<ShapeBundle>, ffi.Pointer<ffi.Char>)>();
+
+  ffi.Pointer<CollisionShape> shape_bundle_get_shape(
+    ffi.Pointer<ShapeBundle> bundle,
+    int id,
+  ) {
+    return _shape_bundle_get_shape(
+      bundle,
+      id,
+    );
+  }
+
+  late final _shape_bundle_get_shapePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<CollisionShape> Function(ffi.Pointer<ShapeBundle>, ffi.Int)>>('shape_bundle_get_shape');
+  late final _shape_bundle_get_shape = _shape_bundle_get_shapePtr.asFunction<
+      ffi.Pointer<CollisionShape> Function(ffi.Pointer<ShapeBundle>, int)>();
+
+  void shape_bundle_get_stats(
+    ffi.Pointer<ShapeBundle> bundle,
+    ffi.Pointer<ShapeBundleStats> stats,
+  ) {
+    return _shape_bundle_get_stats(
+      bundle,
+      stats,
+    );
+  }
+
+  late final _shape_bundle_get_statsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ShapeBundle>,
+              ffi.Pointer<ShapeBundleStats>)>>('shape_bundle_get_stats');
+  late final _shape_bundle_get_stats = _shape_bundle_get_statsPtr.asFunction<
+      void Function(ffi.Pointer<ShapeBundle>,
+          ffi.Pointer<ShapeBundleStats>)>();
+
+  void shape_bundle_close(
+    ffi.Pointer<ShapeBundle> bundle,
+  ) {
+    return _shape_bundle_close(
+      bundle,
+    );
+  }
+
+  late final _shape_bundle_closePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ShapeBundle>)>>('shape_bundle_close');
+  late final _shape_bundle_close = _shape_bundle_closePtr.asFunction<
+      void Function(ffi.Pointer<ShapeBundle>)>();
+
   void shape_set_dart_owner(
     ffi.Pointer<CollisionShape> shape,
     Object owner,
@@ -842,6 +1634,50 @@ class Jolt {
   late final _body_get_active = _body_get_activePtr
       .asFunction<bool Function(ffi.Pointer<WorldBody>)>(isLeaf: true);
 
+  int body_get_index(
+    ffi.Pointer<WorldBody> body,
+  ) {
+    return _body_get_index(
+      body,
+    );
+  }
+
+  late final _body_get_indexPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Uint32 Function(ffi.Pointer<WorldBody>)>>('body_get_index');
+  late final _body_get_index = _body_get_indexPtr.asFunction<
+      int Function(ffi.Pointer<WorldBody>)>(isLeaf: true);
+
+  void body_set_contact_events(
+    ffi.Pointer<WorldBody> body,
+    bool enabled,
+  ) {
+    return _body_set_contact_events(
+      body,
+      enabled,
+    );
+  }
+
+  late final _body_set_contact_eventsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<WorldBody>, ffi.Bool)>>('body_set_contact_events');
+  late final _body_set_contact_events = _body_set_contact_eventsPtr.asFunction<
+      void Function(ffi.Pointer<WorldBody>, bool)>(isLeaf: true);
+
+  int body_get_mirror_slot(
+    ffi.Pointer<WorldBody> body,
+  ) {
+    return _body_get_mirror_slot(
+      body,
+    );
+  }
+
+  late final _body_get_mirror_slotPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<WorldBody>)>>('body_get_mirror_slot');
+  late final _body_get_mirror_slot = _body_get_mirror_slotPtr.asFunction<
+      int Function(ffi.Pointer<WorldBody>)>(isLeaf: true);
+
   void set_body_dart_owner(
     ffi.Pointer<WorldBody> body,
     Object owner,
@@ -981,7 +1817,18 @@ class _SymbolAddresses {
       get native_malloc => _library._native_mallocPtr;
   ffi.Pointer<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>
       get native_free => _library._native_freePtr;
-  ffi.Pointer<ffi.NativeFunction<ffi.Pointer<World> Function()>>
+  ffi.Pointer<ffi.NativeFunction<ffi.Bool Function(ffi.Int, ffi.Int)>>
+      get job_system_configure => _library._job_system_configurePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<ffi.Void Function(JobTask, ffi.Pointer<ffi.Void>)>>
+      get job_system_run_task => _library._job_system_run_taskPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<ffi.Void Function(ffi.Pointer<WorldConfig>)>>
+      get world_config_init_defaults =>
+          _library._world_config_init_defaultsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<World> Function(ffi.Pointer<WorldConfig>)>>
       get create_world => _library._create_worldPtr;
   ffi.Pointer<
           ffi.NativeFunction<
@@ -997,14 +1844,94 @@ class _SymbolAddresses {
           ffi.NativeFunction<
               ffi.Void Function(ffi.Pointer<World>, ffi.Pointer<WorldBody>)>>
       get world_remove_body => _library._world_remove_bodyPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<World>,
+              ffi.Pointer<BodyConfig>,
+              ffi.Int,
+              ffi.Pointer<ffi.Pointer<WorldBody>>)>>
+      get world_create_bodies => _library._world_create_bodiesPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<World>,
+              ffi.Pointer<ffi.Pointer<WorldBody>>,
+              ffi.Int,
+              ffi.Int)>>
+      get world_add_bodies => _library._world_add_bodiesPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<BodyBatch> Function(ffi.Pointer<World>,
+              ffi.Pointer<ffi.Pointer<WorldBody>>,
+              ffi.Int)>>
+      get world_add_bodies_prepare => _library._world_add_bodies_preparePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<World>,
+              ffi.Pointer<BodyBatch>,
+              ffi.Int)>>
+      get world_add_bodies_finalize => _library._world_add_bodies_finalizePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<World>, ffi.Pointer<BodyBatch>)>>
+      get world_add_bodies_abort => _library._world_add_bodies_abortPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<TransformMirror> Function(ffi.Pointer<World>, ffi.Int, ffi.Bool)>>
+      get world_enable_transform_mirror => _library._world_enable_transform_mirrorPtr;
   ffi.Pointer<
           ffi.NativeFunction<ffi.Int Function(ffi.Pointer<World>, ffi.Float)>>
       get world_step => _library._world_stepPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<World>, ffi.Pointer<StepConfig>)>>
+      get world_set_step_config => _library._world_set_step_configPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Float Function(ffi.Pointer<World>)>>
+      get world_get_interpolation_alpha => _library._world_get_interpolation_alphaPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Bool Function(ffi.Pointer<World>, ffi.Float, Dart_Port_DL)>>
+      get world_step_async => _library._world_step_asyncPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Int Function(ffi.Pointer<World>)>>
+      get world_step_wait => _library._world_step_waitPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Bool Function(ffi.Pointer<World>)>>
+      get world_step_poll => _library._world_step_pollPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<ContactEventBuffer> Function(ffi.Pointer<World>, ffi.Int)>>
+      get world_enable_contact_events => _library._world_enable_contact_eventsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<ActivationEvents> Function(ffi.Pointer<World>)>>
+      get world_enable_activation_events => _library._world_enable_activation_eventsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<SensorEvents> Function(ffi.Pointer<World>)>>
+      get world_enable_sensor_events => _library._world_enable_sensor_eventsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Int Function(ffi.Pointer<World>,
+              ffi.Pointer<BodyTransform>,
+              ffi.Int)>>
+      get world_get_active_transforms => _library._world_get_active_transformsPtr;
   ffi.Pointer<
           ffi.NativeFunction<
               ffi.Void Function(
                   ffi.Pointer<World>, ffi.Pointer<RayCastConfig>)>>
       get world_raycast => _library._world_raycastPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<World>,
+              ffi.Pointer<Ray>,
+              ffi.Int,
+              ffi.Pointer<RayCastHit>,
+              ffi.Int)>>
+      get world_raycast_batch => _library._world_raycast_batchPtr;
   ffi.Pointer<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<World>)>>
       get destroy_world => _library._destroy_worldPtr;
   ffi.Pointer<
@@ -1027,11 +1954,84 @@ class _SymbolAddresses {
               ffi.Pointer<ffi.Uint32>,
               ffi.Int)>> get create_mesh_shape =>
       _library._create_mesh_shapePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+              ffi.Pointer<MeshInput>)>>
+      get create_convex_shape_strided => _library._create_convex_shape_stridedPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<CollisionShape> Function(ffi.Pointer<MeshInput>)>>
+      get create_mesh_shape_strided => _library._create_mesh_shape_stridedPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int)>>
+      get create_convex_shape_strided_flat => _library._create_convex_shape_strided_flatPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<CollisionShape> Function(ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int,
+              ffi.Int,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Int,
+              ffi.Int)>>
+      get create_mesh_shape_strided_flat => _library._create_mesh_shape_strided_flatPtr;
   ffi.Pointer<
       ffi.NativeFunction<
           ffi.Pointer<CollisionShape> Function(
               ffi.Pointer<DecoratedShapeConfig>)>> get create_decorated_shape =>
       _library._create_decorated_shapePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<CollisionShape> Function(ffi.Pointer<ConvexShapeConfig>,
+              ffi.Pointer<MeshInput>,
+              ffi.Int)>>
+      get create_simplified_hull_shape => _library._create_simplified_hull_shapePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<CollisionShape> Function(ffi.Pointer<MeshInput>,
+              ffi.Pointer<DecompositionConfig>)>>
+      get create_decomposed_shape => _library._create_decomposed_shapePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ConvexShapeConfig>,
+              ffi.Pointer<ffi.Float>,
+              ffi.Int,
+              Dart_Port_DL,
+              ffi.Int64)>>
+      get create_convex_shape_async => _library._create_convex_shape_asyncPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ffi.Float>,
+              ffi.Int,
+              ffi.Pointer<ffi.Uint32>,
+              ffi.Int,
+              Dart_Port_DL,
+              ffi.Int64)>>
+      get create_mesh_shape_async => _library._create_mesh_shape_asyncPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<CompoundShapeConfig>,
+              ffi.Int,
+              Dart_Port_DL,
+              ffi.Int64)>>
+      get create_compound_shape_async => _library._create_compound_shape_asyncPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<MeshInput>,
+              ffi.Pointer<DecompositionConfig>,
+              Dart_Port_DL,
+              ffi.Int64)>>
+      get create_decomposed_shape_async => _library._create_decomposed_shape_asyncPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ShapeCacheStats>)>>
+      get shape_cache_get_stats => _library._shape_cache_get_statsPtr;
   ffi.Pointer<
           ffi.NativeFunction<
               ffi.Void Function(
@@ -1042,6 +2042,50 @@ class _SymbolAddresses {
           ffi.Void Function(ffi.Pointer<CollisionShape>, ffi.Pointer<ffi.Float>,
               ffi.Pointer<ffi.Float>)>> get shape_get_local_bounds =>
       _library._shape_get_local_boundsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Int Function(ffi.Pointer<CollisionShape>)>>
+      get shape_get_num_hull_points => _library._shape_get_num_hull_pointsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Int Function(ffi.Pointer<CollisionShape>)>>
+      get shape_get_num_sub_shapes => _library._shape_get_num_sub_shapesPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<ffi.Uint8> Function(ffi.Pointer<CollisionShape>, ffi.Pointer<ffi.Int>)>>
+      get shape_save_binary => _library._shape_save_binaryPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<CollisionShape> Function(ffi.Pointer<ffi.Uint8>, ffi.Size)>>
+      get shape_restore_binary => _library._shape_restore_binaryPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Bool Function(ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Pointer<CollisionShape>>,
+              ffi.Pointer<ffi.Pointer<ffi.Char>>,
+              ffi.Int)>>
+      get shape_bundle_write => _library._shape_bundle_writePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<ShapeBundle> Function(ffi.Pointer<ffi.Char>)>>
+      get shape_bundle_open => _library._shape_bundle_openPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Int Function(ffi.Pointer<ShapeBundle>, ffi.Pointer<ffi.Char>)>>
+      get shape_bundle_find => _library._shape_bundle_findPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<CollisionShape> Function(ffi.Pointer<ShapeBundle>, ffi.Int)>>
+      get shape_bundle_get_shape => _library._shape_bundle_get_shapePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ShapeBundle>,
+              ffi.Pointer<ShapeBundleStats>)>>
+      get shape_bundle_get_stats => _library._shape_bundle_get_statsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ShapeBundle>)>>
+      get shape_bundle_close => _library._shape_bundle_closePtr;
   ffi.Pointer<
           ffi.NativeFunction<
               ffi.Void Function(ffi.Pointer<CollisionShape>, ffi.Handle)>>
@@ -1088,6 +2132,18 @@ class _SymbolAddresses {
       get body_set_active => _library._body_set_activePtr;
   ffi.Pointer<ffi.NativeFunction<ffi.Bool Function(ffi.Pointer<WorldBody>)>>
       get body_get_active => _library._body_get_activePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Uint32 Function(ffi.Pointer<WorldBody>)>>
+      get body_get_index => _library._body_get_indexPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<WorldBody>, ffi.Bool)>>
+      get body_set_contact_events => _library._body_set_contact_eventsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Int Function(ffi.Pointer<WorldBody>)>>
+      get body_get_mirror_slot => _library._body_get_mirror_slotPtr;
   ffi.Pointer<
           ffi.NativeFunction<
               ffi.Void Function(ffi.Pointer<WorldBody>, ffi.Handle)>>
@@ -1542,6 +2598,70 @@ final class CollisionShape extends ffi.Opaque {}
 
 final class WorldBody extends ffi.Opaque {}
 
+final class BodyBatch extends ffi.Opaque {}
+
+final class ShapeBundle extends ffi.Opaque {}
+
+/// Configuration for a world when it is created. Use world_config_init_defaults
+/// to get the default values.
+final class WorldConfig extends ffi.Struct {
+  /// Max number of rigid bodies that can be added to the world. Default 65536.
+  @ffi.Int()
+  external int max_bodies;
+
+  /// Number of mutexes protecting rigid bodies from concurrent access. 0 picks a
+  /// default based on max_bodies.
+  @ffi.Int()
+  external int num_body_mutexes;
+
+  /// Max number of body pairs that can be queued for the narrow phase. If the
+  /// queue fills up the broad phase jobs start to do narrow phase work, which is
+  /// slightly less efficient. Default 65536.
+  @ffi.Int()
+  external int max_body_pairs;
+
+  /// Size of the contact constraint buffer. Contacts beyond this are dropped and
+  /// bodies will start interpenetrating. Default 10240.
+  @ffi.Int()
+  external int max_contact_constraints;
+
+  /// Bytes of scratch memory used during a step. Default 10 MB.
+  @ffi.Int()
+  external int temp_allocator_size;
+
+  /// Number of worker threads. 0 steps on the calling thread only and -1 uses
+  /// one thread less than the number of hardware threads. Default -1.
+  @ffi.Int()
+  external int num_threads;
+
+  /// Default (0, -9.81, 0).
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Float> gravity;
+
+  /// 1 puts every object in a single broad phase layer, 2 separates static
+  /// objects and 3 also separates sensors. Default 2.
+  @ffi.Int()
+  external int num_broad_phase_layers;
+}
+
+/// Controls how world_step advances the simulation.
+final class StepConfig extends ffi.Struct {
+  /// Internal time step in seconds. When > 0 world_step adds its dt to an
+  /// accumulator and runs as many updates of fixed_dt as fit. When 0 world_step
+  /// runs a single update of dt.
+  @ffi.Float()
+  external double fixed_dt;
+
+  /// Max number of fixed updates per world_step. Whole steps beyond this are
+  /// dropped.
+  @ffi.Int()
+  external int max_substeps;
+
+  /// Number of collision steps per update.
+  @ffi.Int()
+  external int collision_steps;
+}
+
 /// Configuration for a body when it si created.
 final class BodyConfig extends ffi.Struct {
   external ffi.Pointer<CollisionShape> shape;
@@ -1563,6 +2683,11 @@ final class BodyConfig extends ffi.Struct {
 
   @ffi.Int()
   external int motion_quality;
+
+  /// Sensors report overlaps through world_enable_sensor_events instead of
+  /// colliding. They only detect moving bodies.
+  @ffi.Bool()
+  external bool is_sensor;
 }
 
 abstract class ConvexShapeConfigType {
@@ -1612,6 +2737,100 @@ final class DecoratedShapeConfig extends ffi.Struct {
   external ffi.Array<ffi.Float> q4;
 }
 
+abstract class MeshIndexType {
+  static const int kMeshIndexU16 = 0;
+  static const int kMeshIndexU32 = 1;
+}
+
+/// Positions and triangles in caller owned buffers, for example interleaved
+/// render buffers. Only read during the call.
+final class MeshInput extends ffi.Struct {
+  external ffi.Pointer<ffi.Void> vertices;
+
+  @ffi.Int()
+  external int num_vertices;
+
+  /// Bytes from one vertex to the next, 0 for tightly packed positions.
+  @ffi.Int()
+  external int vertex_stride;
+
+  /// Bytes from the start of a vertex to its x, y, z floats.
+  @ffi.Int()
+  external int position_offset;
+
+  /// Three indices per triangle. Ignored for convex hulls.
+  external ffi.Pointer<ffi.Void> indices;
+
+  @ffi.Int()
+  external int num_triangles;
+
+  /// MeshIndexType.
+  @ffi.Int()
+  external int index_type;
+}
+
+/// Convex decomposition of a concave mesh. Zero fields use the defaults.
+final class DecompositionConfig extends ffi.Struct {
+  /// Upper bound on the number of convex hulls.
+  @ffi.Int()
+  external int max_convex_hulls;
+
+  /// Number of voxels used to approximate the mesh.
+  @ffi.Int()
+  external int resolution;
+
+  /// Upper bound on the vertices of each hull.
+  @ffi.Int()
+  external int max_vertices_per_hull;
+
+  /// Density of every hull.
+  @ffi.Float()
+  external double density;
+}
+
+final class ShapeCacheStats extends ffi.Struct {
+  /// create_convex_shape, create_decorated_shape and create_mesh_shape calls
+  /// that returned an existing shape.
+  @ffi.Int64()
+  external int hits;
+
+  @ffi.Int64()
+  external int misses;
+
+  /// Number of distinct interned shapes alive.
+  @ffi.Int()
+  external int num_shapes;
+}
+
+final class ShapeBundleStats extends ffi.Struct {
+  /// Number of shapes in the bundle.
+  @ffi.Int()
+  external int num_shapes;
+
+  /// Number of shapes restored so far.
+  @ffi.Int()
+  external int num_restored;
+
+  /// Time spent mapping the file and reading the table of contents.
+  @ffi.Double()
+  external double open_ms;
+
+  /// Total time spent restoring shapes.
+  @ffi.Double()
+  external double restore_ms;
+
+  /// Size of the mapped file and how much of it is currently in memory.
+  @ffi.Int64()
+  external int mapped_bytes;
+
+  @ffi.Int64()
+  external int resident_bytes;
+
+  /// Memory used by the restored shapes.
+  @ffi.Int64()
+  external int restored_shape_bytes;
+}
+
 final class CompoundShapeConfig extends ffi.Struct {
   external ffi.Pointer<CollisionShape> shape;
 
@@ -1622,6 +2841,13 @@ final class CompoundShapeConfig extends ffi.Struct {
   external ffi.Array<ffi.Float> rotation;
 }
 
+abstract class RayCastFlags {
+  /// The caller guarantees that no step is running. Hits are collected first
+  /// and normals are resolved afterwards without taking body locks. Set in
+  /// RayCastConfig.flags or or'ed into the mode of world_raycast_batch.
+  static const int kRayCastNoLock = 256;
+}
+
 final class RayCastConfig extends ffi.Struct {
   @ffi.Array.multi([3])
   external ffi.Array<ffi.Float> start;
@@ -1629,8 +2855,201 @@ final class RayCastConfig extends ffi.Struct {
   @ffi.Array.multi([3])
   external ffi.Array<ffi.Float> end;
 
+  /// RayCastFlags.
+  @ffi.Int()
+  external int flags;
+
   external ffi.Pointer<
       ffi.NativeFunction<
           ffi.Float Function(ffi.Handle body, ffi.Float fraction,
               ffi.Pointer<ffi.Float> n)>> cb;
 }
+
+final class Ray extends ffi.Struct {
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Float> start;
+
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Float> end;
+}
+
+abstract class RayCastMode {
+  /// Report the closest hit along the ray.
+  static const int kRayCastClosest = 0;
+
+  /// Report any hit along the ray. Cheaper, for line of sight checks.
+  static const int kRayCastAny = 1;
+}
+
+/// Result of a single ray in world_raycast_batch.
+final class RayCastHit extends ffi.Struct {
+  /// Index of the body that was hit as returned by body_get_index, -1 if the
+  /// ray didn't hit anything.
+  @ffi.Int32()
+  external int body_index;
+
+  @ffi.Uint32()
+  external int sub_shape_id;
+
+  @ffi.Float()
+  external double fraction;
+
+  /// World space surface normal at the hit.
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Float> normal;
+}
+
+abstract class ContactEventType {
+  static const int kContactAdded = 0;
+  static const int kContactPersisted = 1;
+  static const int kContactRemoved = 2;
+}
+
+final class ContactEvent extends ffi.Struct {
+  /// ContactEventType.
+  @ffi.Int()
+  external int type;
+
+  /// Indices of the bodies as returned by body_get_index.
+  @ffi.Uint32()
+  external int body_index1;
+
+  @ffi.Uint32()
+  external int body_index2;
+
+  @ffi.Uint32()
+  external int sub_shape_id1;
+
+  @ffi.Uint32()
+  external int sub_shape_id2;
+
+  /// World space contact point on body 1. Zero for kContactRemoved.
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Float> point;
+
+  /// Contact normal pointing from body 1 to body 2. Zero for kContactRemoved.
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Float> normal;
+
+  /// Estimated impulse needed to stop the bodies from approaching each other
+  /// along the normal. Zero for kContactRemoved.
+  @ffi.Float()
+  external double impulse;
+}
+
+/// Contact events recorded during the last world_step. Owned by the World and
+/// never reallocated.
+final class ContactEventBuffer extends ffi.Struct {
+  external ffi.Pointer<ContactEvent> events;
+
+  @ffi.Int()
+  external int capacity;
+
+  /// Number of valid entries in events.
+  @ffi.Int()
+  external int count;
+
+  /// Number of events that didn't fit in the buffer.
+  @ffi.Int()
+  external int dropped;
+}
+
+/// Activity state of the bodies in a World. Owned by the World.
+final class ActivationEvents extends ffi.Struct {
+  /// One bit per body index, set while the body is active. Updated as soon as
+  /// a body is activated or deactivated.
+  external ffi.Pointer<ffi.Uint64> active_bits;
+
+  @ffi.Int()
+  external int num_words;
+
+  /// Indices of the bodies that were activated or deactivated between the two
+  /// most recent world_step calls. Valid until the next step. A body that
+  /// changed state more than once shows up in both lists, active_bits has its
+  /// final state.
+  external ffi.Pointer<ffi.Uint32> activated;
+
+  @ffi.Int()
+  external int num_activated;
+
+  external ffi.Pointer<ffi.Uint32> deactivated;
+
+  @ffi.Int()
+  external int num_deactivated;
+}
+
+abstract class SensorEventType {
+  static const int kSensorEnter = 0;
+  static const int kSensorExit = 1;
+}
+
+final class SensorEvent extends ffi.Struct {
+  /// SensorEventType.
+  @ffi.Int()
+  external int type;
+
+  /// Indices of the bodies as returned by body_get_index.
+  @ffi.Uint32()
+  external int sensor_index;
+
+  @ffi.Uint32()
+  external int other_index;
+}
+
+/// Sensor overlaps that started or ended during the last world_step. Owned by
+/// the World, events is valid until the next step.
+final class SensorEvents extends ffi.Struct {
+  external ffi.Pointer<SensorEvent> events;
+
+  @ffi.Int()
+  external int count;
+}
+
+/// World transform of an active body as written by world_get_active_transforms.
+final class BodyTransform extends ffi.Struct {
+  /// Index of the body as returned by body_get_index.
+  @ffi.Uint32()
+  external int body_index;
+
+  /// Column major world matrix.
+  @ffi.Array.multi([16])
+  external ffi.Array<ffi.Float> m16;
+}
+
+/// Triple buffered copy of body transforms owned by the World and refreshed at
+/// the end of every world_step. Arrays are indexed by body_get_mirror_slot and
+/// are never reallocated.
+final class TransformMirror extends ffi.Struct {
+  /// Incremented after every step. Readers use positions[generation % 3] for
+  /// the last step and positions[(generation + 2) % 3] for the one before. A
+  /// step in flight only writes positions[(generation + 1) % 3].
+  @ffi.Uint64()
+  external int generation;
+
+  /// Number of slots in each array.
+  @ffi.Int()
+  external int capacity;
+
+  /// 4 floats per slot (x, y, z, unused).
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Pointer<ffi.Float>> positions;
+
+  /// 4 floats per slot (x, y, z, w).
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Pointer<ffi.Float>> rotations;
+
+  /// 16 floats per slot, column major. Null unless matrices were requested.
+  @ffi.Array.multi([3])
+  external ffi.Array<ffi.Pointer<ffi.Float>> matrices;
+}
+
+abstract class JobPriority {
+  static const int kJobPriorityNormal = 0;
+  static const int kJobPriorityLow = 1;
+  static const int kJobPriorityHigh = 2;
+}
+
+/// Unit of work for job_system_run_task.
+typedef JobTask = ffi.Pointer<ffi.NativeFunction<JobTaskFunction>>;
+typedef JobTaskFunction = ffi.Void Function(ffi.Pointer<ffi.Void> data);
+typedef DartJobTaskFunction = void Function(ffi.Pointer<ffi.Void> data);
@@ -44,7 +44,102 @@ final class RayHit {
 // be invoked for every Collidable that the ray hits.
 typedef OnRayHit = double Function(RayHit hit);
 
-// Perform a ray cast into world. The ray moves from start to end.
-void rayCast(World world, Vector3 start, Vector3 end, OnRayHit onRayHit) {
-  world._rayCast(start, end, onRayHit);
+// Perform a ray cast into world. The ray moves from start to end. Throws a
+// [StateError] while a [World.stepAsync] step is in flight.
+// Pass lockFree when no step is running to collect all hits first and compute
+// normals without taking body locks. Hits are then reported in order of
+// distance.
+void rayCast(World world, Vector3 start, Vector3 end, OnRayHit onRayHit,
+    {bool lockFree = false}) {
+  world._rayCast(start, end, onRayHit, lockFree);
+}
+
+enum RayCastMode {
+  // Report the closest hit along each ray.
+  closest,
+  // Report any hit along each ray. Cheaper, for line of sight checks.
+  any,
+}
+
+// Casts many rays in one native call. The rays are spread across the world's
+// job system and no Dart callbacks are made. Rays and hits live in native
+// memory that is reused between casts.
+class RayCastBatch implements ffi.Finalizable {
+  static final _finalizer =
+      ffi.NativeFinalizer(jolt.bindings.addresses.native_free.cast());
+
+  // Rays followed by one hit per ray, in a single allocation.
+  final ffi.Pointer<jolt.Ray> _rays;
+  final ffi.Pointer<jolt.RayCastHit> _hits;
+
+  final int capacity;
+  int _length = 0;
+  World? _world;
+
+  RayCastBatch._(this.capacity, ffi.Pointer<ffi.Uint8> storage)
+      : _rays = storage.cast(),
+        _hits = ffi.Pointer<jolt.RayCastHit>.fromAddress(
+            storage.address + ffi.sizeOf<jolt.Ray>() * capacity) {
+    _finalizer.attach(this, storage.cast(), detach: this);
+  }
+
+  factory RayCastBatch(int capacity) {
+    final storage = jolt.bindings.native_malloc(
+        (ffi.sizeOf<jolt.Ray>() + ffi.sizeOf<jolt.RayCastHit>()) * capacity);
+    return RayCastBatch._(capacity, storage);
+  }
+
+  int get length {
+    return _length;
+  }
+
+  void clear() {
+    _length = 0;
+    _world = null;
+  }
+
+  // Adds a ray moving from start to end. Returns its index.
+  int add(Vector3 start, Vector3 end) {
+    if (_length >= capacity) {
+      throw StateError('RayCastBatch is full');
+    }
+    copyVector3(start, _rays[_length].start);
+    copyVector3(end, _rays[_length].end);
+    return _length++;
+  }
+
+  // Pass lockFree when no step is running to compute normals without taking
+  // body locks. Throws a [StateError] while a [World.stepAsync] step is in
+  // flight.
+  void cast(World world,
+      {RayCastMode mode = RayCastMode.closest, bool lockFree = false}) {
+    world._checkNotStepping();
+    _world = world;
+    final flags = lockFree ? jolt.RayCastFlags.kRayCastNoLock : 0;
+    jolt.bindings.world_raycast_batch(
+        world._nativeWorld, _rays, _length, _hits, mode.index | flags);
+  }
+
+  // Hit for the ray at index i from the last cast, null if it hit nothing or
+  // the body it hit has since been removed from the world.
+  RayHit? operator [](int i) {
+    if (i < 0 || i >= _length) {
+      throw IndexError.withLength(i, _length);
+    }
+    final hit = _hits[i];
+    if (hit.body_index < 0 || _world == null) {
+      return null;
+    }
+    final body = _world!._bodyAtIndex(hit.body_index);
+    if (body == null) {
+      return null;
+    }
+    final ray = _rays[i];
+    return RayHit(
+        body,
+        Vector3(hit.normal[0], hit.normal[1], hit.normal[2]),
+        hit.fraction,
+        Vector3(ray.start[0], ray.start[1], ray.start[2]),
+        Vector3(ray.end[0], ray.end[1], ray.end[2]));
+  }
 }
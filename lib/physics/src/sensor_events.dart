@@ -0,0 +1,37 @@
+part of '../physics.dart';
+
+enum SensorEventType { enter, exit }
+
+class SensorEvent {
+  final SensorEventType type;
+  // Either body can be null if it was removed from the world since the step.
+  final Body? sensor;
+  final Body? other;
+
+  SensorEvent._(this.type, this.sensor, this.other);
+}
+
+/// Bodies that started or stopped overlapping a sensor during the most recent
+/// [World.step].
+///
+/// Sensors are created with [BodySettings.isSensor]. The broadphase finds the
+/// overlaps so there is no need to test every sensor against every body.
+class SensorEvents {
+  final World _world;
+  final ffi.Pointer<jolt.SensorEvents> _native;
+
+  SensorEvents._(this._world, this._native);
+
+  int get length {
+    return _native.ref.count;
+  }
+
+  SensorEvent operator [](int index) {
+    RangeError.checkValidIndex(index, this, 'index', length);
+    final event = _native.ref.events[index];
+    return SensorEvent._(
+        SensorEventType.values[event.type],
+        _world._bodyAtIndex(event.sensor_index),
+        _world._bodyAtIndex(event.other_index));
+  }
+}
@@ -3,20 +3,89 @@ part of '../physics.dart';
 // TODO:
 // - MutableCompoundShape.
 // - HeightFieldShape.
-// - Serialization.
-// - Baked serialization.
 // - plumb support for subshapeid.
 
 class Shape implements ffi.Finalizable {
   static final _finalizer =
       ffi.NativeFinalizer(jolt.bindings.addresses.destroy_shape.cast());
 
+  // Native shapes are interned, creating a shape equal to a live one returns
+  // the same native shape. Wrappers are shared the same way, keyed by the
+  // native address.
+  static final Map<int, WeakReference<Shape>> _wrappers =
+      <int, WeakReference<Shape>>{};
+  static final _wrapperFinalizer = Finalizer<int>((int address) {
+    if (_wrappers[address]?.target == null) {
+      _wrappers.remove(address);
+    }
+  });
+
   ffi.Pointer<jolt.CollisionShape> _nativeShape;
 
   Shape._(this._nativeShape) {
     _finalizer.attach(this, _nativeShape.cast(), detach: this);
     jolt.bindings.shape_set_dart_owner(_nativeShape, this);
     assert(identical(jolt.bindings.shape_get_dart_owner(_nativeShape), this));
+    _wrappers[_nativeShape.address] = WeakReference<Shape>(this);
+    _wrapperFinalizer.attach(this, _nativeShape.address);
+  }
+
+  // Returns the live wrapper of nativeShape and drops the extra native
+  // reference the caller got, or null if nativeShape has no wrapper yet.
+  static T? _existing<T extends Shape>(
+      ffi.Pointer<jolt.CollisionShape> nativeShape) {
+    final shape = _wrappers[nativeShape.address]?.target;
+    if (shape is! T) {
+      return null;
+    }
+    jolt.bindings.destroy_shape(nativeShape);
+    return shape;
+  }
+
+  // Calls start with a native port and completes with the shape the native
+  // worker posts to it.
+  static Future<ffi.Pointer<jolt.CollisionShape>> _buildAsync(
+      void Function(int nativePort) start) {
+    final completer = Completer<ffi.Pointer<jolt.CollisionShape>>();
+    final port = RawReceivePort();
+    port.handler = (dynamic message) {
+      port.close();
+      // [request id, shape address].
+      final int address = (message as List)[1];
+      if (address == 0) {
+        completer.completeError(StateError('Shape construction failed'));
+      } else {
+        completer
+            .complete(ffi.Pointer<jolt.CollisionShape>.fromAddress(address));
+      }
+    };
+    start(port.sendPort.nativePort);
+    return completer.future;
+  }
+
+  // Serializes the shape and its sub shapes, including the BVHs of mesh and
+  // compound shapes, so that [Shape.restoreBinary] can load it without
+  // rebuilding anything.
+  Uint8List saveBinary() {
+    final ffi.Pointer<ffi.Int> size = calloc.allocate(ffi.sizeOf<ffi.Int>());
+    final data = jolt.bindings.shape_save_binary(_nativeShape, size);
+    final result = Uint8List.fromList(data.asTypedList(size.value));
+    jolt.bindings.native_free(data.cast());
+    calloc.free(size);
+    return result;
+  }
+
+  // Recreates a shape written by [saveBinary].
+  static Shape restoreBinary(Uint8List data) {
+    final ffi.Pointer<ffi.Uint8> nativeData = calloc.allocate(data.length);
+    nativeData.asTypedList(data.length).setAll(0, data);
+    final nativeShape =
+        jolt.bindings.shape_restore_binary(nativeData, data.length);
+    calloc.free(nativeData);
+    if (nativeShape == ffi.nullptr) {
+      throw ArgumentError.value(data, 'data', 'Not a valid shape binary');
+    }
+    return Shape._(nativeShape);
   }
 
   static final unwrappedGetCenterOfMass = jolt.dylib.lookupFunction<
@@ -59,6 +128,26 @@ class Shape implements ffi.Finalizable {
   }
 }
 
+class ShapeCacheStats {
+  // Shape creations that returned an existing shape.
+  final int hits;
+  final int misses;
+  // Distinct interned shapes that are alive.
+  final int liveShapes;
+
+  ShapeCacheStats._(this.hits, this.misses, this.liveShapes);
+}
+
+ShapeCacheStats shapeCacheStats() {
+  final ffi.Pointer<jolt.ShapeCacheStats> stats =
+      calloc.allocate(ffi.sizeOf<jolt.ShapeCacheStats>());
+  jolt.bindings.shape_cache_get_stats(stats);
+  final result = ShapeCacheStats._(
+      stats.ref.hits, stats.ref.misses, stats.ref.num_shapes);
+  calloc.free(stats);
+  return result;
+}
+
 class ConvexShapeSettings {
   // Uniform density of the interior of the convex object (kg / m^3)
   double density = 1000.0;
@@ -102,7 +191,7 @@ class BoxShape extends ConvexShape {
     final nativeShape =
         jolt.bindings.create_convex_shape(config, ffi.nullptr, 0);
     calloc.free(config);
-    return BoxShape._(nativeShape);
+    return Shape._existing<BoxShape>(nativeShape) ?? BoxShape._(nativeShape);
   }
 }
 
@@ -132,7 +221,8 @@ class SphereShape extends ConvexShape {
     final nativeShape =
         jolt.bindings.create_convex_shape(config, ffi.nullptr, 0);
     calloc.free(config);
-    return SphereShape._(nativeShape);
+    return Shape._existing<SphereShape>(nativeShape) ??
+        SphereShape._(nativeShape);
   }
 }
 
@@ -171,7 +261,8 @@ class CapsuleShape extends ConvexShape {
     final nativeShape =
         jolt.bindings.create_convex_shape(config, ffi.nullptr, 0);
     calloc.free(config);
-    return CapsuleShape._(nativeShape);
+    return Shape._existing<CapsuleShape>(nativeShape) ??
+        CapsuleShape._(nativeShape);
   }
 }
 
@@ -200,20 +291,103 @@ class ConvexHullShape extends ConvexShape {
           ffi.Pointer<ffi.Float>,
           int)>('create_convex_shape', isLeaf: true);
 
-  factory ConvexHullShape(ConvexHullShapeSettings settings) {
-    ffi.Pointer<jolt.ConvexShapeConfig> config =
-        calloc.allocate(ffi.sizeOf<jolt.ConvexShapeConfig>());
-    settings._copyToConvexShapeConfig(config);
+  static ffi.Pointer<ffi.Float> _copyPoints(ConvexHullShapeSettings settings) {
     ffi.Pointer<ffi.Float> points =
         calloc.allocate<ffi.Float>(settings.points.length);
     for (int i = 0; i < settings.points.length; i++) {
       points[i] = settings.points[i];
     }
+    return points;
+  }
+
+  factory ConvexHullShape(ConvexHullShapeSettings settings) {
+    ffi.Pointer<jolt.ConvexShapeConfig> config =
+        calloc.allocate(ffi.sizeOf<jolt.ConvexShapeConfig>());
+    settings._copyToConvexShapeConfig(config);
+    ffi.Pointer<ffi.Float> points = _copyPoints(settings);
     final nativeShape =
         unwrappedCreateConvexShape(config, points, settings.points.length ~/ 3);
     calloc.free(config);
     calloc.free(points);
-    return ConvexHullShape._(nativeShape);
+    return Shape._existing<ConvexHullShape>(nativeShape) ??
+        ConvexHullShape._(nativeShape);
+  }
+
+  // Builds a hull of at most maxVertices of the points, picked with
+  // quickhull, 0 for no limit. Much cheaper to collide with than a hull of
+  // every point of a detailed mesh.
+  factory ConvexHullShape.simplified(ConvexHullShapeSettings settings,
+      {int maxVertices = 32}) {
+    ffi.Pointer<jolt.ConvexShapeConfig> config =
+        calloc.allocate(ffi.sizeOf<jolt.ConvexShapeConfig>());
+    settings._copyToConvexShapeConfig(config);
+    final ffi.Pointer<jolt.MeshInput> input =
+        calloc.allocate(ffi.sizeOf<jolt.MeshInput>());
+    final points = _copyPoints(settings);
+    input.ref.vertices = points.cast();
+    input.ref.num_vertices = settings.points.length ~/ 3;
+    final nativeShape =
+        jolt.bindings.create_simplified_hull_shape(config, input, maxVertices);
+    calloc.free(points);
+    calloc.free(input);
+    calloc.free(config);
+    return Shape._existing<ConvexHullShape>(nativeShape) ??
+        ConvexHullShape._(nativeShape);
+  }
+
+  // Number of points on the hull.
+  int get numPoints {
+    return jolt.bindings.shape_get_num_hull_points(_nativeShape);
+  }
+
+  static final unwrappedCreateConvexShapeStrided = jolt.dylib.lookupFunction<
+      ffi.Pointer<jolt.CollisionShape> Function(
+          ffi.Pointer<jolt.ConvexShapeConfig>,
+          ffi.Pointer<ffi.Uint8>,
+          ffi.Int,
+          ffi.Int,
+          ffi.Int),
+      ffi.Pointer<jolt.CollisionShape> Function(
+          ffi.Pointer<jolt.ConvexShapeConfig>,
+          Uint8List,
+          int,
+          int,
+          int)>('create_convex_shape_strided_flat', isLeaf: true);
+
+  // Builds the hull from the positions in an interleaved vertex buffer,
+  // without copying it.
+  factory ConvexHullShape.strided(StridedMeshSettings settings,
+      {double density = 1000.0}) {
+    ffi.Pointer<jolt.ConvexShapeConfig> config =
+        calloc.allocate(ffi.sizeOf<jolt.ConvexShapeConfig>());
+    config.ref.type = jolt.ConvexShapeConfigType.kConvexHull;
+    config.ref.density = density;
+    final nativeShape = unwrappedCreateConvexShapeStrided(
+        config,
+        settings.vertices.asUint8List(),
+        settings.vertexCount,
+        settings.vertexStride,
+        settings.positionOffset);
+    calloc.free(config);
+    return Shape._existing<ConvexHullShape>(nativeShape) ??
+        ConvexHullShape._(nativeShape);
+  }
+
+  // Builds the hull on a native worker thread.
+  static Future<ConvexHullShape> createAsync(
+      ConvexHullShapeSettings settings) async {
+    ffi.Pointer<jolt.ConvexShapeConfig> config =
+        calloc.allocate(ffi.sizeOf<jolt.ConvexShapeConfig>());
+    settings._copyToConvexShapeConfig(config);
+    ffi.Pointer<ffi.Float> points = _copyPoints(settings);
+    final future = Shape._buildAsync((int port) => jolt.bindings
+        .create_convex_shape_async(
+            config, points, settings.points.length ~/ 3, port, 0));
+    calloc.free(config);
+    calloc.free(points);
+    final nativeShape = await future;
+    return Shape._existing<ConvexHullShape>(nativeShape) ??
+        ConvexHullShape._(nativeShape);
   }
 }
 
@@ -251,7 +425,8 @@ class CompoundShape extends Shape {
   CompoundShape._(ffi.Pointer<jolt.CollisionShape> nativeShape)
       : super._(nativeShape);
 
-  factory CompoundShape(CompoundShapeSettings settings) {
+  static ffi.Pointer<jolt.CompoundShapeConfig> _allocateConfigs(
+      CompoundShapeSettings settings) {
     ffi.Pointer<jolt.CompoundShapeConfig> configs = calloc
         .allocate(ffi.sizeOf<jolt.CompoundShapeConfig>() * settings.length);
     int configsAddress = configs.address;
@@ -263,12 +438,89 @@ class CompoundShape extends Shape {
           configsAddress + ffi.sizeOf<jolt.CompoundShapeConfig>() * i);
     }
     settings._copyToCompoundShapeConfig(configs_array);
-    final nativeShape = jolt.bindings.create_compound_shape(
-        ffi.Pointer<jolt.CompoundShapeConfig>.fromAddress(configsAddress),
-        settings.length);
+    return configs;
+  }
+
+  factory CompoundShape(CompoundShapeSettings settings) {
+    final configs = _allocateConfigs(settings);
+    final nativeShape =
+        jolt.bindings.create_compound_shape(configs, settings.length);
     calloc.free(configs);
     return CompoundShape._(nativeShape);
   }
+
+  // Builds the compound and its bounding volume hierarchy on a native worker
+  // thread.
+  static Future<CompoundShape> createAsync(
+      CompoundShapeSettings settings) async {
+    final configs = _allocateConfigs(settings);
+    final future = Shape._buildAsync((int port) => jolt.bindings
+        .create_compound_shape_async(configs, settings.length, port, 0));
+    calloc.free(configs);
+    return CompoundShape._(await future);
+  }
+
+  // Number of shapes the compound is made of.
+  int get numSubShapes {
+    return jolt.bindings.shape_get_num_sub_shapes(_nativeShape);
+  }
+
+  static ffi.Pointer<jolt.DecompositionConfig> _allocateDecompositionConfig(
+      DecompositionSettings settings) {
+    final ffi.Pointer<jolt.DecompositionConfig> config =
+        calloc.allocate(ffi.sizeOf<jolt.DecompositionConfig>());
+    config.ref.max_convex_hulls = settings.maxConvexHulls;
+    config.ref.resolution = settings.resolution;
+    config.ref.max_vertices_per_hull = settings.maxVerticesPerHull;
+    config.ref.density = settings.density;
+    return config;
+  }
+
+  // Splits a concave mesh into convex hulls with V-HACD and combines them
+  // into one compound, without the hulls leaving native code. Blocks the
+  // calling isolate for the whole decomposition, which can take seconds for
+  // large meshes, see [decomposeAsync].
+  factory CompoundShape.decompose(StridedMeshSettings mesh,
+      [DecompositionSettings? settings]) {
+    final ffi.Pointer<jolt.MeshInput> input =
+        calloc.allocate(ffi.sizeOf<jolt.MeshInput>());
+    mesh._copyToMeshInput(input);
+    final config =
+        _allocateDecompositionConfig(settings ?? DecompositionSettings());
+    final nativeShape = jolt.bindings.create_decomposed_shape(input, config);
+    StridedMeshSettings._freeMeshInput(input);
+    calloc.free(config);
+    if (nativeShape == ffi.nullptr) {
+      throw StateError('Convex decomposition produced no hulls');
+    }
+    return Shape._existing<CompoundShape>(nativeShape) ??
+        CompoundShape._(nativeShape);
+  }
+
+  // Like [CompoundShape.decompose] but runs V-HACD on a native worker thread.
+  static Future<CompoundShape> decomposeAsync(StridedMeshSettings mesh,
+      [DecompositionSettings? settings]) async {
+    final ffi.Pointer<jolt.MeshInput> input =
+        calloc.allocate(ffi.sizeOf<jolt.MeshInput>());
+    mesh._copyToMeshInput(input);
+    final config =
+        _allocateDecompositionConfig(settings ?? DecompositionSettings());
+    final future = Shape._buildAsync((int port) => jolt.bindings
+        .create_decomposed_shape_async(input, config, port, 0));
+    StridedMeshSettings._freeMeshInput(input);
+    calloc.free(config);
+    final nativeShape = await future;
+    return Shape._existing<CompoundShape>(nativeShape) ??
+        CompoundShape._(nativeShape);
+  }
+}
+
+// Controls [CompoundShape.decompose]. Zero keeps the V-HACD default.
+class DecompositionSettings {
+  int maxConvexHulls = 0;
+  int resolution = 0;
+  int maxVerticesPerHull = 0;
+  double density = 1000.0;
 }
 
 final emptyUint32List = Uint32List(0);
@@ -281,6 +533,81 @@ class MeshShapeSettings {
     assert(vertices.length % 3 == 0);
     assert(indices.length % 3 == 0);
   }
+
+  void _copyTo(ffi.Pointer<ffi.Float> nativeVertices,
+      ffi.Pointer<ffi.Uint32> nativeIndices) {
+    nativeVertices.asTypedList(vertices.length).setAll(0, vertices);
+    nativeIndices.asTypedList(indices.length).setAll(0, indices);
+  }
+}
+
+enum MeshIndexWidth { uint16, uint32 }
+
+// Collision geometry inside interleaved render buffers. Each vertex is
+// vertexStride bytes and has its position as three floats at positionOffset.
+class StridedMeshSettings {
+  StridedMeshSettings(this.vertices, this.vertexStride,
+      {this.positionOffset = 0,
+      this.indices,
+      this.indexWidth = MeshIndexWidth.uint32});
+
+  ByteBuffer vertices;
+  int vertexStride;
+  int positionOffset;
+  // Three indices per triangle. Not used for convex hulls.
+  ByteBuffer? indices;
+  MeshIndexWidth indexWidth;
+
+  int get vertexCount {
+    // 0 means tightly packed positions, as in native code.
+    return vertices.lengthInBytes ~/ (vertexStride == 0 ? 12 : vertexStride);
+  }
+
+  int get _nativeIndexType {
+    return indexWidth == MeshIndexWidth.uint16
+        ? jolt.MeshIndexType.kMeshIndexU16
+        : jolt.MeshIndexType.kMeshIndexU32;
+  }
+
+  int get triangleCount {
+    if (indices == null) {
+      return 0;
+    }
+    final indexSize = indexWidth == MeshIndexWidth.uint16 ? 2 : 4;
+    return indices!.lengthInBytes ~/ indexSize ~/ 3;
+  }
+
+  // Fills input with a bulk copy of the buffers in their original layout, for
+  // calls that can't take typed data directly. Free with [_freeMeshInput].
+  _copyToMeshInput(ffi.Pointer<jolt.MeshInput> input) {
+    final ffi.Pointer<ffi.Uint8> nativeVertices =
+        calloc.allocate(vertices.lengthInBytes);
+    nativeVertices
+        .asTypedList(vertices.lengthInBytes)
+        .setAll(0, vertices.asUint8List());
+    input.ref.vertices = nativeVertices.cast();
+    input.ref.num_vertices = vertexCount;
+    input.ref.vertex_stride = vertexStride;
+    input.ref.position_offset = positionOffset;
+    input.ref.index_type = _nativeIndexType;
+    input.ref.num_triangles = triangleCount;
+    if (indices != null) {
+      final ffi.Pointer<ffi.Uint8> nativeIndices =
+          calloc.allocate(indices!.lengthInBytes);
+      nativeIndices
+          .asTypedList(indices!.lengthInBytes)
+          .setAll(0, indices!.asUint8List());
+      input.ref.indices = nativeIndices.cast();
+    }
+  }
+
+  static _freeMeshInput(ffi.Pointer<jolt.MeshInput> input) {
+    calloc.free(input.ref.vertices);
+    if (input.ref.indices != ffi.nullptr) {
+      calloc.free(input.ref.indices);
+    }
+    calloc.free(input);
+  }
 }
 
 class MeshShape extends Shape {
@@ -298,17 +625,49 @@ class MeshShape extends Shape {
         calloc.allocate<ffi.Float>(settings.vertices.length);
     ffi.Pointer<ffi.Uint32> indices =
         calloc.allocate<ffi.Uint32>(settings.indices.length);
-    for (int i = 0; i < settings.vertices.length; i++) {
-      vertices[i] = settings.vertices[i];
-    }
-    for (int i = 0; i < settings.indices.length; i++) {
-      indices[i] = settings.indices[i];
-    }
+    settings._copyTo(vertices, indices);
     final nativeShape = unwrappedCreateMeshShape(vertices,
         settings.vertices.length ~/ 3, indices, settings.indices.length ~/ 3);
     calloc.free(vertices);
     calloc.free(indices);
-    return MeshShape._(nativeShape);
+    return Shape._existing<MeshShape>(nativeShape) ?? MeshShape._(nativeShape);
+  }
+
+  static final unwrappedCreateMeshShapeStrided = jolt.dylib.lookupFunction<
+      ffi.Pointer<jolt.CollisionShape> Function(ffi.Pointer<ffi.Uint8>,
+          ffi.Int, ffi.Int, ffi.Int, ffi.Pointer<ffi.Uint8>, ffi.Int, ffi.Int),
+      ffi.Pointer<jolt.CollisionShape> Function(Uint8List, int, int, int,
+          Uint8List, int, int)>('create_mesh_shape_strided_flat', isLeaf: true);
+
+  // Builds the mesh straight from interleaved vertex and index buffers,
+  // without copying them.
+  factory MeshShape.strided(StridedMeshSettings settings) {
+    final nativeShape = unwrappedCreateMeshShapeStrided(
+        settings.vertices.asUint8List(),
+        settings.vertexCount,
+        settings.vertexStride,
+        settings.positionOffset,
+        settings.indices?.asUint8List() ?? Uint8List(0),
+        settings.triangleCount,
+        settings._nativeIndexType);
+    return Shape._existing<MeshShape>(nativeShape) ?? MeshShape._(nativeShape);
+  }
+
+  // Builds the mesh and its bounding volume hierarchy on a native worker
+  // thread.
+  static Future<MeshShape> createAsync(MeshShapeSettings settings) async {
+    ffi.Pointer<ffi.Float> vertices =
+        calloc.allocate<ffi.Float>(settings.vertices.length);
+    ffi.Pointer<ffi.Uint32> indices =
+        calloc.allocate<ffi.Uint32>(settings.indices.length);
+    settings._copyTo(vertices, indices);
+    final future = Shape._buildAsync((int port) => jolt.bindings
+        .create_mesh_shape_async(vertices, settings.vertices.length ~/ 3,
+            indices, settings.indices.length ~/ 3, port, 0));
+    calloc.free(vertices);
+    calloc.free(indices);
+    final nativeShape = await future;
+    return Shape._existing<MeshShape>(nativeShape) ?? MeshShape._(nativeShape);
   }
 }
 
@@ -351,7 +710,8 @@ class ScaledShape extends DecoratedShape {
     settings._copyToDecoratedShapeConfig(config);
     final nativeShape = jolt.bindings.create_decorated_shape(config);
     calloc.free(config);
-    return ScaledShape._(nativeShape);
+    return Shape._existing<ScaledShape>(nativeShape) ??
+        ScaledShape._(nativeShape);
   }
 }
 
@@ -386,7 +746,8 @@ class TransformedShape extends DecoratedShape {
     settings._copyToDecoratedShapeConfig(config);
     final nativeShape = jolt.bindings.create_decorated_shape(config);
     calloc.free(config);
-    return TransformedShape._(nativeShape);
+    return Shape._existing<TransformedShape>(nativeShape) ??
+        TransformedShape._(nativeShape);
   }
 }
 
@@ -415,6 +776,7 @@ class OffsetCenterOfMassShape extends DecoratedShape {
     settings._copyToDecoratedShapeConfig(config);
     final nativeShape = jolt.bindings.create_decorated_shape(config);
     calloc.free(config);
-    return OffsetCenterOfMassShape._(nativeShape);
+    return Shape._existing<OffsetCenterOfMassShape>(nativeShape) ??
+        OffsetCenterOfMassShape._(nativeShape);
   }
 }
@@ -0,0 +1,128 @@
+part of '../physics.dart';
+
+class ShapeBundleStats {
+  // Number of shapes in the bundle and how many have been restored so far.
+  final int shapes;
+  final int restoredShapes;
+  // Time spent mapping the file and reading the table of contents.
+  final Duration openTime;
+  // Total time spent restoring shapes.
+  final Duration restoreTime;
+  // Size of the bundle file and how much of it is currently in memory.
+  final int mappedBytes;
+  final int residentBytes;
+  // Memory used by the restored shapes.
+  final int restoredShapeBytes;
+
+  ShapeBundleStats._(this.shapes, this.restoredShapes, this.openTime,
+      this.restoreTime, this.mappedBytes, this.residentBytes,
+      this.restoredShapeBytes);
+}
+
+Duration _milliseconds(double ms) {
+  return Duration(microseconds: (ms * 1000).round());
+}
+
+/// A memory mapped file of baked shapes.
+///
+/// Bundles are written offline with [ShapeBundle.write]. Opening one only
+/// reads its table of contents, each shape is restored the first time it is
+/// looked up. Restored shapes are regular [Shape]s.
+class ShapeBundle implements ffi.Finalizable {
+  static final _finalizer =
+      ffi.NativeFinalizer(jolt.bindings.addresses.shape_bundle_close.cast());
+
+  ffi.Pointer<jolt.ShapeBundle> _nativeBundle;
+
+  ShapeBundle._(this._nativeBundle) {
+    _finalizer.attach(this, _nativeBundle.cast(), detach: this);
+  }
+
+  // Throws if path can't be mapped or isn't a shape bundle.
+  factory ShapeBundle.open(String path) {
+    final nativePath = path.toNativeUtf8(allocator: calloc);
+    final nativeBundle = jolt.bindings.shape_bundle_open(nativePath.cast());
+    calloc.free(nativePath);
+    if (nativeBundle == ffi.nullptr) {
+      throw ArgumentError.value(path, 'path', 'Not a shape bundle');
+    }
+    return ShapeBundle._(nativeBundle);
+  }
+
+  // Writes shapes to path. Their ids in the bundle follow the iteration order
+  // of shapes.
+  static void write(String path, Map<String, Shape> shapes) {
+    final names = shapes.keys.toList();
+    final ffi.Pointer<ffi.Pointer<jolt.CollisionShape>> nativeShapes =
+        calloc.allocate(ffi.sizeOf<ffi.Pointer>() * names.length);
+    final ffi.Pointer<ffi.Pointer<ffi.Char>> nativeNames =
+        calloc.allocate(ffi.sizeOf<ffi.Pointer>() * names.length);
+    for (int i = 0; i < names.length; i++) {
+      nativeShapes[i] = shapes[names[i]]!._nativeShape;
+      nativeNames[i] = names[i].toNativeUtf8(allocator: calloc).cast();
+    }
+    final nativePath = path.toNativeUtf8(allocator: calloc);
+    final ok = jolt.bindings.shape_bundle_write(
+        nativePath.cast(), nativeShapes, nativeNames, names.length);
+    calloc.free(nativePath);
+    for (int i = 0; i < names.length; i++) {
+      calloc.free(nativeNames[i]);
+    }
+    calloc.free(nativeNames);
+    calloc.free(nativeShapes);
+    if (!ok) {
+      throw StateError('Failed to write shape bundle $path');
+    }
+  }
+
+  // Returns the id of the shape called name or -1.
+  int find(String name) {
+    final nativeName = name.toNativeUtf8(allocator: calloc);
+    final id =
+        jolt.bindings.shape_bundle_find(_nativeBundle, nativeName.cast());
+    calloc.free(nativeName);
+    return id;
+  }
+
+  // Returns the shape with the given id, restoring it on first use.
+  Shape shapeAt(int id) {
+    final nativeShape =
+        jolt.bindings.shape_bundle_get_shape(_nativeBundle, id);
+    if (nativeShape == ffi.nullptr) {
+      throw ArgumentError.value(id, 'id', 'No valid shape with this id');
+    }
+    return Shape._existing<Shape>(nativeShape) ?? Shape._(nativeShape);
+  }
+
+  // Returns the shape called name, or null if the bundle has none.
+  Shape? operator [](String name) {
+    final id = find(name);
+    return id < 0 ? null : shapeAt(id);
+  }
+
+  ShapeBundleStats get stats {
+    final ffi.Pointer<jolt.ShapeBundleStats> stats =
+        calloc.allocate(ffi.sizeOf<jolt.ShapeBundleStats>());
+    jolt.bindings.shape_bundle_get_stats(_nativeBundle, stats);
+    final result = ShapeBundleStats._(
+        stats.ref.num_shapes,
+        stats.ref.num_restored,
+        _milliseconds(stats.ref.open_ms),
+        _milliseconds(stats.ref.restore_ms),
+        stats.ref.mapped_bytes,
+        stats.ref.resident_bytes,
+        stats.ref.restored_shape_bytes);
+    calloc.free(stats);
+    return result;
+  }
+
+  // Unmaps the bundle. Shapes that were looked up stay valid.
+  void close() {
+    if (_nativeBundle == ffi.nullptr) {
+      return;
+    }
+    _finalizer.detach(this);
+    jolt.bindings.shape_bundle_close(_nativeBundle);
+    _nativeBundle = ffi.nullptr;
+  }
+}
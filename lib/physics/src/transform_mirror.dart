@@ -0,0 +1,144 @@
+part of '../physics.dart';
+
+/// Triple buffered copy of the transforms of every body in a [World].
+///
+/// The native world refreshes the mirror at the end of every [World.step] and
+/// then flips which buffer is current, so reading transforms from here does
+/// not call into native code. A step started with [World.stepAsync] writes
+/// the third buffer only, so the current and previous transforms can be read
+/// and interpolated while it runs. Which buffers are read is snapshotted when
+/// a step completes on the Dart side, never in the middle of a frame.
+class TransformMirror {
+  final ffi.Pointer<jolt.TransformMirror> _native;
+  final int capacity;
+
+  final List<Float32List> _positions;
+  final List<Float32List> _rotations;
+  final List<Float32List>? _matrices;
+
+  static const int _buffers = 3;
+
+  // generation as of the last step that completed on the Dart side.
+  int _generation;
+
+  // Scratch values for interpolatedMatrix.
+  static final _position = Vector3.zero();
+  static final _rotation = Quaternion.identity();
+
+  TransformMirror._(this._native)
+      : capacity = _native.ref.capacity,
+        _generation = _native.ref.generation,
+        _positions = _views(_native.ref.positions, _native.ref.capacity * 4)!,
+        _rotations = _views(_native.ref.rotations, _native.ref.capacity * 4)!,
+        _matrices = _views(_native.ref.matrices, _native.ref.capacity * 16);
+
+  static List<Float32List>? _views(
+      ffi.Array<ffi.Pointer<ffi.Float>> halves, int length) {
+    if (halves[0] == ffi.nullptr) {
+      return null;
+    }
+    return <Float32List>[
+      for (int i = 0; i < _buffers; i++) halves[i].asTypedList(length)
+    ];
+  }
+
+  // Called by [World] once a step has completed.
+  void _latch() {
+    _generation = _native.ref.generation;
+  }
+
+  // Incremented every time the world publishes new transforms. Only changes
+  // when a step completes on the Dart side.
+  int get generation {
+    return _generation;
+  }
+
+  int get _front {
+    return _generation % _buffers;
+  }
+
+  int get _previous {
+    return (_generation + _buffers - 1) % _buffers;
+  }
+
+  // Returns true if transforms for body are available from the mirror.
+  bool contains(Body body) {
+    return body._mirrorSlot >= 0 && body._mirrorSlot < capacity;
+  }
+
+  Vector3 position(Body body, [Vector3? out]) {
+    out ??= Vector3.zero();
+    if (!contains(body)) {
+      out.setFrom(body.position);
+      return out;
+    }
+    final p = _positions[_front];
+    final offset = body._mirrorSlot * 4;
+    out.setValues(p[offset + 0], p[offset + 1], p[offset + 2]);
+    return out;
+  }
+
+  Quaternion rotation(Body body, [Quaternion? out]) {
+    out ??= Quaternion.identity();
+    if (!contains(body)) {
+      out.setFrom(body.rotation);
+      return out;
+    }
+    final r = _rotations[_front];
+    final offset = body._mirrorSlot * 4;
+    out.setValues(r[offset + 0], r[offset + 1], r[offset + 2], r[offset + 3]);
+    return out;
+  }
+
+  // World transform of body blended between the previous and the current
+  // step. Use [World.interpolationAlpha] as alpha when fixed stepping.
+  Matrix4 interpolatedMatrix(Body body, double alpha, [Matrix4? out]) {
+    out ??= Matrix4.zero();
+    if (!contains(body) || alpha >= 1.0) {
+      return matrix(body, out);
+    }
+    final offset = body._mirrorSlot * 4;
+    final front = _front;
+    final previous = _previous;
+    final p0 = _positions[previous];
+    final p1 = _positions[front];
+    final r0 = _rotations[previous];
+    final r1 = _rotations[front];
+    final position = _position
+      ..setValues(
+          p0[offset + 0] + (p1[offset + 0] - p0[offset + 0]) * alpha,
+          p0[offset + 1] + (p1[offset + 1] - p0[offset + 1]) * alpha,
+          p0[offset + 2] + (p1[offset + 2] - p0[offset + 2]) * alpha);
+    // Normalized lerp along the shortest arc.
+    final dot = r0[offset + 0] * r1[offset + 0] +
+        r0[offset + 1] * r1[offset + 1] +
+        r0[offset + 2] * r1[offset + 2] +
+        r0[offset + 3] * r1[offset + 3];
+    final sign = dot < 0.0 ? -1.0 : 1.0;
+    final rotation = _rotation
+      ..setValues(
+          r0[offset + 0] + (sign * r1[offset + 0] - r0[offset + 0]) * alpha,
+          r0[offset + 1] + (sign * r1[offset + 1] - r0[offset + 1]) * alpha,
+          r0[offset + 2] + (sign * r1[offset + 2] - r0[offset + 2]) * alpha,
+          r0[offset + 3] + (sign * r1[offset + 3] - r0[offset + 3]) * alpha)
+      ..normalize();
+    out.setFromTranslationRotation(position, rotation);
+    return out;
+  }
+
+  Matrix4 matrix(Body body, [Matrix4? out]) {
+    out ??= Matrix4.zero();
+    if (!contains(body)) {
+      out.setFrom(body.worldTransform);
+      return out;
+    }
+    if (_matrices == null) {
+      out.setFromTranslationRotation(
+          position(body, _position), rotation(body, _rotation));
+      return out;
+    }
+    out.storage.setRange(
+        0, 16, _matrices![_front], body._mirrorSlot * 16);
+    return out;
+  }
+}
@@ -20,30 +20,204 @@ enum PhysicsLayer {
   sensor,
 }
 
+enum JobSystemPriority { normal, low, high }
+
+/// Sets the number of threads and their priority for the worker pool shared
+/// by worlds, async shape construction and, when wired up with
+/// [jobSystemExecutor], convex decomposition jobs. [threads] -1 uses one less
+/// than the number of hardware threads, and the pool always keeps at least
+/// one. Only applies before the pool starts, which happens when the first
+/// world using it or async shape is created. Returns false and changes nothing
+/// after that.
+bool configureJobSystem(
+    {int threads = -1,
+    JobSystemPriority priority = JobSystemPriority.normal}) {
+  final int nativePriority = switch (priority) {
+    JobSystemPriority.normal => JobPriority.kJobPriorityNormal,
+    JobSystemPriority.low => JobPriority.kJobPriorityLow,
+    JobSystemPriority.high => JobPriority.kJobPriorityHigh,
+  };
+  return jolt.bindings.job_system_configure(threads, nativePriority);
+}
+
+/// Native executor running tasks on the shared worker pool. Pass it to
+/// setConvexDecompositionExecutor so decomposition doesn't start threads of
+/// its own.
+ffi.Pointer<ffi.Void> get jobSystemExecutor =>
+    jolt.bindings.addresses.job_system_run_task.cast();
+
+/// Capacities and tuning for a [World]. Fields left null use the native
+/// defaults, which suit a large game world.
+class WorldSettings {
+  // Max number of rigid bodies that can be added to the world.
+  int? maxBodies;
+  // Number of mutexes protecting bodies from concurrent access. 0 picks a
+  // default based on maxBodies.
+  int? numBodyMutexes;
+  // Max number of body pairs queued between the broad and narrow phase.
+  int? maxBodyPairs;
+  // Contacts beyond this are dropped and bodies will interpenetrate.
+  int? maxContactConstraints;
+  // Bytes of scratch memory used during a step.
+  int? tempAllocatorSize;
+  // Number of worker threads. 0 steps on the calling thread only, a positive
+  // value gives the world threads of its own and -1 (the default) steps on
+  // the pool shared with other worlds, see [configureJobSystem].
+  int? numThreads;
+  Vector3? gravity;
+  // 1 puts everything in one broad phase layer, 2 separates static objects
+  // and 3 also separates sensors.
+  int? numBroadPhaseLayers;
+
+  _copyToConfig(ffi.Pointer<jolt.WorldConfig> config) {
+    if (maxBodies != null) {
+      config.ref.max_bodies = maxBodies!;
+    }
+    if (numBodyMutexes != null) {
+      config.ref.num_body_mutexes = numBodyMutexes!;
+    }
+    if (maxBodyPairs != null) {
+      config.ref.max_body_pairs = maxBodyPairs!;
+    }
+    if (maxContactConstraints != null) {
+      config.ref.max_contact_constraints = maxContactConstraints!;
+    }
+    if (tempAllocatorSize != null) {
+      config.ref.temp_allocator_size = tempAllocatorSize!;
+    }
+    if (numThreads != null) {
+      config.ref.num_threads = numThreads!;
+    }
+    if (gravity != null) {
+      copyVector3(gravity!, config.ref.gravity);
+    }
+    if (numBroadPhaseLayers != null) {
+      config.ref.num_broad_phase_layers = numBroadPhaseLayers!;
+    }
+  }
+}
+
+/// Controls how [World.step] advances the simulation.
+class StepSettings {
+  // Internal time step in seconds. When set, [World.step] accumulates its dt
+  // and runs as many updates of this size as fit, up to maxSubsteps. When 0,
+  // every [World.step] runs a single update of dt.
+  double fixedTimeStep = 0.0;
+  // Whole steps beyond this are dropped when the simulation falls behind.
+  int maxSubsteps = 4;
+  // Number of collision steps per update.
+  int collisionSteps = 1;
+
+  _copyToConfig(ffi.Pointer<jolt.StepConfig> config) {
+    config.ref.fixed_dt = fixedTimeStep;
+    config.ref.max_substeps = maxSubsteps;
+    config.ref.collision_steps = collisionSteps;
+  }
+}
+
 /// Physics world that can be populated with rigid bodies.
 class World implements ffi.Finalizable {
   static final _finalizer =
       ffi.NativeFinalizer(jolt.bindings.addresses.destroy_world.cast());
+  static final _scratchFinalizer =
+      ffi.NativeFinalizer(jolt.bindings.addresses.native_free.cast());
 
   ffi.Pointer<jolt.World> _nativeWorld;
 
   final Set<Body> _bodies = Set<Body>();
 
+  // Added bodies indexed by their native body index.
+  final List<Body?> _bodiesByIndex = <Body?>[];
+
+  // Scratch buffer filled by world_get_active_transforms. Allocated with
+  // native_malloc and freed by _scratchFinalizer.
+  ffi.Pointer<jolt.BodyTransform> _activeTransforms = ffi.nullptr;
+  int _activeTransformsCapacity = 0;
+
+  TransformMirror? _transformMirror;
+
+  ContactEvents? _contactEvents;
+
+  ActivationEvents? _activationEvents;
+
+  SensorEvents? _sensorEvents;
+
   World._(this._nativeWorld) {
     _finalizer.attach(this, _nativeWorld.cast(), detach: this);
   }
 
-  factory World() {
-    final nativeWorld = jolt.bindings.create_world();
+  factory World([WorldSettings? settings]) {
+    final ffi.Pointer<jolt.WorldConfig> config =
+        calloc.allocate(ffi.sizeOf<jolt.WorldConfig>());
+    jolt.bindings.world_config_init_defaults(config);
+    settings?._copyToConfig(config);
+    final nativeWorld = jolt.bindings.create_world(config);
+    calloc.free(config);
     return World._(nativeWorld);
   }
 
   // Step the simulation forward by dt.
   void step(double dt) {
     jolt.bindings.world_step(_nativeWorld, dt);
+    _transformMirror?._latch();
+  }
+
+  // Steps the simulation on a native thread. The returned future completes
+  // once the step is done. Until then bodies must not be created, modified or
+  // queried, and the calls that would do so throw a [StateError]. The
+  // [TransformMirror] can still be read and interpolated, it keeps showing the
+  // previous step until the future completes.
+  Future<void> stepAsync(double dt) {
+    final completer = Completer<void>();
+    final port = RawReceivePort();
+    port.handler = (dynamic result) {
+      port.close();
+      _transformMirror?._latch();
+      completer.complete();
+    };
+    if (!jolt.bindings
+        .world_step_async(_nativeWorld, dt, port.sendPort.nativePort)) {
+      port.close();
+      throw StateError('A step is already in flight');
+    }
+    return completer.future;
+  }
+
+  // Blocks until the step started by [stepAsync] is done.
+  void waitForStep() {
+    jolt.bindings.world_step_wait(_nativeWorld);
+    _transformMirror?._latch();
+  }
+
+  // True while a step started by [stepAsync] is running.
+  bool get isStepping {
+    return !jolt.bindings.world_step_poll(_nativeWorld);
+  }
+
+  // Native state these calls touch is in use by the step thread.
+  void _checkNotStepping() {
+    if (isStepping) {
+      throw StateError('A step is in flight');
+    }
+  }
+
+  // Configures fixed time stepping. Resets the accumulated time.
+  set stepSettings(StepSettings settings) {
+    final ffi.Pointer<jolt.StepConfig> config =
+        calloc.allocate(ffi.sizeOf<jolt.StepConfig>());
+    settings._copyToConfig(config);
+    jolt.bindings.world_set_step_config(_nativeWorld, config);
+    calloc.free(config);
+  }
+
+  // How far the accumulated time is between the previous and the current
+  // fixed step, between 0.0 and 1.0. Always 1.0 without a fixed time step.
+  double get interpolationAlpha {
+    return jolt.bindings.world_get_interpolation_alpha(_nativeWorld);
   }
 
   RigidBody createRigidBody(BodySettings settings) {
+    _checkNotStepping();
     final ffi.Pointer<jolt.BodyConfig> config =
         calloc.allocate(ffi.sizeOf<jolt.BodyConfig>());
     settings._copyToConfig(config);
@@ -52,25 +226,208 @@ class World implements ffi.Finalizable {
     return RigidBody._(this, nativeBody, settings.shape);
   }
 
+  // Creates a rigid body for every entry in settings with a single native
+  // call.
+  List<RigidBody> createRigidBodies(List<BodySettings> settings) {
+    _checkNotStepping();
+    final int configSize = ffi.sizeOf<jolt.BodyConfig>();
+    final ffi.Pointer<jolt.BodyConfig> configs =
+        calloc.allocate(configSize * settings.length);
+    for (int i = 0; i < settings.length; i++) {
+      settings[i]._copyToConfig(ffi.Pointer<jolt.BodyConfig>.fromAddress(
+          configs.address + configSize * i));
+    }
+    final ffi.Pointer<ffi.Pointer<jolt.WorldBody>> nativeBodies =
+        calloc.allocate(ffi.sizeOf<ffi.Pointer>() * settings.length);
+    jolt.bindings.world_create_bodies(
+        _nativeWorld, configs, settings.length, nativeBodies);
+    final bodies = List<RigidBody>.generate(settings.length,
+        (i) => RigidBody._(this, nativeBodies[i], settings[i].shape));
+    calloc.free(configs);
+    calloc.free(nativeBodies);
+    return bodies;
+  }
+
+  // Bodies passed to addBody while batching, grouped by activation.
+  List<List<Body>>? _pendingAdds;
+
   void addBody(Body body,
       {Activation activation = Activation.forceActivation}) {
-    if (!_bodies.add(body)) {
+    if (_pendingAdds != null) {
+      _pendingAdds![activation.index].add(body);
+      return;
+    }
+    _checkNotStepping();
+    if (!_track(body)) {
       // Already added.
       return;
     }
     jolt.bindings
         .world_add_body(_nativeWorld, body._nativeBody, activation.index);
+    body._mirrorSlot = jolt.bindings.body_get_mirror_slot(body._nativeBody);
+  }
+
+  // Adds bodies to the world with a single native call. The broadphase is
+  // updated once for the whole batch instead of once per body.
+  void addBodies(Iterable<Body> bodies,
+      {Activation activation = Activation.forceActivation}) {
+    _checkNotStepping();
+    final List<Body> added = <Body>[];
+    for (final body in bodies) {
+      if (_track(body)) {
+        added.add(body);
+      }
+    }
+    if (added.isEmpty) {
+      return;
+    }
+    final ffi.Pointer<ffi.Pointer<jolt.WorldBody>> nativeBodies =
+        calloc.allocate(ffi.sizeOf<ffi.Pointer>() * added.length);
+    for (int i = 0; i < added.length; i++) {
+      nativeBodies[i] = added[i]._nativeBody;
+    }
+    jolt.bindings.world_add_bodies(
+        _nativeWorld, nativeBodies, added.length, activation.index);
+    calloc.free(nativeBodies);
+    for (final body in added) {
+      body._mirrorSlot = jolt.bindings.body_get_mirror_slot(body._nativeBody);
+    }
+  }
+
+  // Every addBody call made while callback runs is deferred and then inserted
+  // with addBodies. Useful when bodies are added indirectly, for example by
+  // ECS components.
+  void batchAdd(void Function() callback) {
+    if (_pendingAdds != null) {
+      // Already batching.
+      callback();
+      return;
+    }
+    final pending = _pendingAdds = List<List<Body>>.generate(
+        Activation.values.length, (_) => <Body>[]);
+    try {
+      callback();
+    } finally {
+      _pendingAdds = null;
+      for (final activation in Activation.values) {
+        addBodies(pending[activation.index], activation: activation);
+      }
+    }
+  }
+
+  // Starts tracking body. Returns false if it was already added.
+  bool _track(Body body) {
+    if (!_bodies.add(body)) {
+      return false;
+    }
+    if (body._index >= _bodiesByIndex.length) {
+      _bodiesByIndex.length = body._index + 1;
+    }
+    _bodiesByIndex[body._index] = body;
+    return true;
   }
 
   void removeBody(Body body) {
+    _checkNotStepping();
+    if (_pendingAdds != null) {
+      // Queued inside batchAdd, don't let the batch add it afterwards.
+      for (final pending in _pendingAdds!) {
+        pending.remove(body);
+      }
+    }
     if (!_bodies.remove(body)) {
       // Not added.
       return;
     }
+    _bodiesByIndex[body._index] = null;
     jolt.bindings.world_remove_body(_nativeWorld, body._nativeBody);
+    body._mirrorSlot = -1;
+  }
+
+  // Returns the world's transform mirror, allocating it on first use. The
+  // arguments are ignored once the mirror exists. Bodies beyond capacity are
+  // read through the regular body getters.
+  TransformMirror enableTransformMirror(
+      {int capacity = 4096, bool matrices = false}) {
+    _transformMirror ??= TransformMirror._(jolt.bindings
+        .world_enable_transform_mirror(_nativeWorld, capacity, matrices));
+    return _transformMirror!;
+  }
+
+  // Returns the world's contact event buffer, allocating it on first use.
+  // capacity is ignored once the buffer exists. Events past capacity are
+  // counted in [ContactEvents.dropped].
+  ContactEvents enableContactEvents({int capacity = 1024}) {
+    _contactEvents ??= ContactEvents._(this,
+        jolt.bindings.world_enable_contact_events(_nativeWorld, capacity));
+    return _contactEvents!;
+  }
+
+  // Returns the world's activation tracker, installing it on first use.
+  ActivationEvents enableActivationEvents() {
+    _activationEvents ??= ActivationEvents._(
+        this, jolt.bindings.world_enable_activation_events(_nativeWorld));
+    return _activationEvents!;
+  }
+
+  // Returns the world's sensor overlap events, installing the tracker on
+  // first use.
+  SensorEvents enableSensorEvents() {
+    _sensorEvents ??= SensorEvents._(
+        this, jolt.bindings.world_enable_sensor_events(_nativeWorld));
+    return _sensorEvents!;
+  }
+
+  Body? _bodyAtIndex(int index) {
+    return index < _bodiesByIndex.length ? _bodiesByIndex[index] : null;
+  }
+
+  static final unwrappedGetActiveTransforms = jolt.dylib.lookupFunction<
+      ffi.Int Function(
+          ffi.Pointer<jolt.World>, ffi.Pointer<jolt.BodyTransform>, ffi.Int),
+      int Function(ffi.Pointer<jolt.World>, ffi.Pointer<jolt.BodyTransform>,
+          int)>('world_get_active_transforms', isLeaf: true);
+
+  // Copies the world transform of every active body into
+  // [Body.syncedWorldTransform] using a single native call.
+  void syncActiveTransforms() {
+    _checkNotStepping();
+    int count = unwrappedGetActiveTransforms(
+        _nativeWorld, _activeTransforms, _activeTransformsCapacity);
+    if (count > _activeTransformsCapacity) {
+      if (_activeTransforms != ffi.nullptr) {
+        _scratchFinalizer.detach(this);
+        jolt.bindings.native_free(_activeTransforms.cast());
+      }
+      _activeTransformsCapacity = count * 2;
+      _activeTransforms = jolt.bindings
+          .native_malloc(
+              ffi.sizeOf<jolt.BodyTransform>() * _activeTransformsCapacity)
+          .cast();
+      _scratchFinalizer.attach(this, _activeTransforms.cast(), detach: this);
+      count = unwrappedGetActiveTransforms(
+          _nativeWorld, _activeTransforms, _activeTransformsCapacity);
+    }
+    final stride = ffi.sizeOf<jolt.BodyTransform>() ~/ 4;
+    final floats =
+        _activeTransforms.cast<ffi.Float>().asTypedList(count * stride);
+    final indices =
+        _activeTransforms.cast<ffi.Uint32>().asTypedList(count * stride);
+    for (int i = 0; i < count; i++) {
+      final offset = i * stride;
+      final body = _bodyAtIndex(indices[offset]);
+      if (body == null) {
+        // Active in native code but not added through this world.
+        continue;
+      }
+      body._syncedWorldTransform.storage.setRange(0, 16, floats, offset + 1);
+      body._syncedWorldTransformDirty = false;
+    }
   }
 
-  void _rayCast(Vector3 start, Vector3 end, OnRayHit onRayHit) {
+  void _rayCast(
+      Vector3 start, Vector3 end, OnRayHit onRayHit, bool lockFree) {
+    _checkNotStepping();
     double closure(
         Object body, double fraction, ffi.Pointer<ffi.Float> normal) {
       assert(body is Body);
@@ -90,6 +447,7 @@ class World implements ffi.Finalizable {
 
     copyVector3(start, native_config.ref.start);
     copyVector3(end, native_config.ref.end);
+    native_config.ref.flags = lockFree ? jolt.RayCastFlags.kRayCastNoLock : 0;
     native_config.ref.cb = callback.nativeFunction;
 
     jolt.bindings.world_raycast(_nativeWorld, native_config);
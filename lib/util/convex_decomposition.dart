@@ -1,4 +1,6 @@
+import 'dart:async';
 import 'dart:ffi' as ffi;
+import 'dart:isolate';
 import 'dart:typed_data';
 import 'dart:collection';
 import 'package:ffi/ffi.dart';
@@ -8,18 +10,26 @@ import 'package:vector_math/vector_math.dart';
 import 'src/v-hacd_ffi.dart' as hacd;
 
 class ConvexHull {
-  ConvexHull._(this._native);
+  ConvexHull._(this._owner, this._native);
 
+  // Keeps the memory the views below point into alive.
+  final ConvexHullDecomposition _owner;
   ffi.Pointer<hacd.ConvexHull> _native;
 
   late final int _numTriangles = _native.ref.indices_size ~/ 3;
   late final int _numVertices = _native.ref.vertices_size ~/ 3;
   late final UnmodifiableFloat32ListView _vertices =
-      UnmodifiableFloat32ListView(
-          _native.ref.vertices.asTypedList(_native.ref.vertices_size));
+      UnmodifiableFloat32ListView(Float32List.sublistView(
+          _owner._vertices,
+          _owner._vertexOffset(_native.ref.vertices),
+          _owner._vertexOffset(_native.ref.vertices) +
+              _native.ref.vertices_size));
   late final UnmodifiableUint32ListView _indices =
-      new UnmodifiableUint32ListView(
-          _native.ref.indices.asTypedList(_native.ref.indices_size));
+      new UnmodifiableUint32ListView(Uint32List.sublistView(
+          _owner._indices,
+          _owner._indexOffset(_native.ref.indices),
+          _owner._indexOffset(_native.ref.indices) +
+              _native.ref.indices_size));
 
   int get numTriangles {
     return _numTriangles;
@@ -38,6 +48,112 @@ class ConvexHull {
   }
 }
 
+// Trade decomposition time for fidelity. balanced matches the V-HACD
+// defaults.
+enum ConvexDecompositionPreset { preview, fast, balanced, high }
+
+enum ConvexDecompositionFillMode {
+  // Flood fill the voxels outside the mesh, everything else is interior.
+  floodFill,
+  // Only voxelize the surface, for meshes that are not closed.
+  surfaceOnly,
+  // Find interior voxels with raycasts, for meshes with small holes.
+  raycast,
+}
+
+class ConvexDecompositionParameters {
+  // Upper bound on the number of convex hulls.
+  int maxConvexHulls = 0;
+  // Number of voxels used to approximate the mesh.
+  int resolution = 0;
+  // Upper bound on the vertices of each hull.
+  int maxVerticesPerHull = 0;
+  // Stop splitting a hull once its volume is within this percentage of the
+  // voxels it covers.
+  double minVolumePercentError = 0.0;
+  // Upper bound on how often hulls are split.
+  int maxRecursionDepth = 0;
+  ConvexDecompositionFillMode fillMode = ConvexDecompositionFillMode.floodFill;
+  // Split hulls on several threads.
+  bool async = true;
+
+  // Starts from the values of preset.
+  ConvexDecompositionParameters(
+      [ConvexDecompositionPreset preset = ConvexDecompositionPreset.balanced]) {
+    final ffi.Pointer<hacd.ConvexHullParameters> native =
+        calloc.allocate(ffi.sizeOf<hacd.ConvexHullParameters>());
+    hacd.bindings.convex_hull_parameters_preset(preset.index, native);
+    maxConvexHulls = native.ref.max_convex_hulls;
+    resolution = native.ref.resolution;
+    maxVerticesPerHull = native.ref.max_vertices_per_hull;
+    minVolumePercentError = native.ref.min_volume_percent_error;
+    maxRecursionDepth = native.ref.max_recursion_depth;
+    fillMode = ConvexDecompositionFillMode.values[native.ref.fill_mode];
+    async = native.ref.async;
+    calloc.free(native);
+  }
+
+  // Returns native parameters, free with calloc.free.
+  ffi.Pointer<hacd.ConvexHullParameters> _toNative() {
+    final ffi.Pointer<hacd.ConvexHullParameters> native =
+        calloc.allocate(ffi.sizeOf<hacd.ConvexHullParameters>());
+    native.ref.max_convex_hulls = maxConvexHulls;
+    native.ref.resolution = resolution;
+    native.ref.max_vertices_per_hull = maxVerticesPerHull;
+    native.ref.min_volume_percent_error = minVolumePercentError;
+    native.ref.max_recursion_depth = maxRecursionDepth;
+    native.ref.fill_mode = fillMode.index;
+    native.ref.async = async;
+    return native;
+  }
+}
+
+// Runs decomposition jobs and batch helpers on executor, a native function
+// with the ConvexHullExecutor signature such as jobSystemExecutor from the
+// physics library, instead of starting threads of their own. While one is set
+// [ConvexDecompositionParameters.async] is ignored so V-HACD starts no threads
+// either. A nullptr goes back to a thread per task.
+void setConvexDecompositionExecutor(ffi.Pointer<ffi.Void> executor) {
+  hacd.bindings.convex_hull_set_executor(executor.cast());
+}
+
+// Stores decompositions in directory so that decomposing the same mesh with
+// the same parameters again, also in a later run, maps the stored result
+// instead of running V-HACD. Once the directory holds more than maxBytes the
+// least recently used results are deleted. A null directory turns the cache
+// off.
+void configureConvexDecompositionCache(String? directory,
+    {int maxBytes = 256 * 1024 * 1024}) {
+  if (directory == null) {
+    hacd.bindings.convex_hull_cache_configure(ffi.nullptr, maxBytes);
+    return;
+  }
+  final nativeDirectory = directory.toNativeUtf8(allocator: calloc);
+  hacd.bindings.convex_hull_cache_configure(nativeDirectory.cast(), maxBytes);
+  calloc.free(nativeDirectory);
+}
+
+class ConvexDecompositionCacheStats {
+  // Decompositions answered from the cache.
+  final int hits;
+  // Decompositions that ran V-HACD and were stored.
+  final int misses;
+  // Results deleted to stay under the size limit.
+  final int evictions;
+
+  ConvexDecompositionCacheStats._(this.hits, this.misses, this.evictions);
+}
+
+ConvexDecompositionCacheStats convexDecompositionCacheStats() {
+  final ffi.Pointer<hacd.ConvexHullCacheStats> stats =
+      calloc.allocate(ffi.sizeOf<hacd.ConvexHullCacheStats>());
+  hacd.bindings.convex_hull_cache_get_stats(stats);
+  final result = ConvexDecompositionCacheStats._(
+      stats.ref.hits, stats.ref.misses, stats.ref.evictions);
+  calloc.free(stats);
+  return result;
+}
+
 class ConvexHullDecomposition implements ffi.Finalizable {
   static final _finalizer = ffi.NativeFinalizer(
       hacd.bindings.addresses.destroy_convex_hull_result.cast());
@@ -46,29 +162,88 @@ class ConvexHullDecomposition implements ffi.Finalizable {
 
   final List<ConvexHull?> _hulls = <ConvexHull?>[];
 
+  // The vertices and indices of all hulls, back to back.
+  late final Float32List _vertices =
+      _native.ref.vertices.asTypedList(_native.ref.vertices_size);
+  late final Uint32List _indices =
+      _native.ref.indices.asTypedList(_native.ref.indices_size);
+
   ConvexHullDecomposition._(this._native) {
-    _finalizer.attach(this, _native.cast(), detach: this);
+    _finalizer.attach(this, _native.cast(),
+        detach: this, externalSize: _native.ref.size);
   }
 
   static final unwrappedComputeConvexHull = hacd.dylib.lookupFunction<
+          ffi.Pointer<hacd.ConvexHullResult> Function(ffi.Pointer<ffi.Float>,
+              ffi.Int, ffi.Pointer<ffi.Uint32>, ffi.Int,
+              ffi.Pointer<hacd.ConvexHullParameters>),
+          ffi.Pointer<hacd.ConvexHullResult> Function(Float32List, int,
+              Uint32List, int, ffi.Pointer<hacd.ConvexHullParameters>)>(
+      'compute_convex_hull_with_parameters',
+      isLeaf: true);
+
+  factory ConvexHullDecomposition(Float32List vertices, Uint32List indices,
+      [ConvexDecompositionParameters? parameters]) {
+    parameters ??= ConvexDecompositionParameters();
+    final nativeParameters = parameters._toNative();
+    final native = unwrappedComputeConvexHull(vertices, vertices.length ~/ 3,
+        indices, indices.length ~/ 3, nativeParameters);
+    calloc.free(nativeParameters);
+    return ConvexHullDecomposition._fromNative(native);
+  }
+
+  static final unwrappedComputeSingleConvexHull = hacd.dylib.lookupFunction<
+      ffi.Pointer<hacd.ConvexHullResult> Function(
+          ffi.Pointer<ffi.Float>, ffi.Uint32, ffi.Uint32),
       ffi.Pointer<hacd.ConvexHullResult> Function(
-          ffi.Pointer<ffi.Float>, ffi.Int, ffi.Pointer<ffi.Uint32>, ffi.Int),
-      ffi.Pointer<hacd.ConvexHullResult> Function(Float32List, int, Uint32List,
-          int)>('compute_convex_hull', isLeaf: true);
+          Float32List, int, int)>('compute_single_convex_hull', isLeaf: true);
+
+  // A single convex hull around vertices, built directly with quickhull
+  // instead of decomposing. The hull keeps at most maxVertices points, 0 for
+  // no limit. Has no hulls if the points are degenerate.
+  factory ConvexHullDecomposition.singleHull(Float32List vertices,
+      {int maxVertices = 64}) {
+    final native = unwrappedComputeSingleConvexHull(
+        vertices, vertices.length ~/ 3, maxVertices);
+    return ConvexHullDecomposition._fromNative(native);
+  }
 
-  factory ConvexHullDecomposition(Float32List vertices, Uint32List indices) {
-    final native = unwrappedComputeConvexHull(
-        vertices, vertices.length ~/ 3, indices, indices.length ~/ 3);
+  factory ConvexHullDecomposition._fromNative(
+      ffi.Pointer<hacd.ConvexHullResult> native) {
+    if (native == ffi.nullptr) {
+      throw StateError('Out of memory for the decomposition result');
+    }
     final result = ConvexHullDecomposition._(native);
-    result._hulls.length =
-        hacd.bindings.convex_hull_result_get_num_convex_hulls(native);
+    result._hulls.length = native.ref.num_hulls;
     return result;
   }
 
+  int _vertexOffset(ffi.Pointer<ffi.Float> vertices) {
+    return (vertices.address - _native.ref.vertices.address) ~/
+        ffi.sizeOf<ffi.Float>();
+  }
+
+  int _indexOffset(ffi.Pointer<ffi.Uint32> indices) {
+    return (indices.address - _native.ref.indices.address) ~/
+        ffi.sizeOf<ffi.Uint32>();
+  }
+
   int get length {
     return _hulls.length;
   }
 
+  // The vertices of all hulls back to back, each hull's
+  // [ConvexHull.vertexData] is a view into this.
+  UnmodifiableFloat32ListView get vertexData {
+    return UnmodifiableFloat32ListView(_vertices);
+  }
+
+  // The indices of all hulls back to back. Indices are relative to the
+  // vertices of their own hull.
+  UnmodifiableUint32ListView get indexData {
+    return UnmodifiableUint32ListView(_indices);
+  }
+
   ConvexHull operator [](int i) {
     if (i < 0 || i >= _hulls.length) {
       throw IndexError.withLength(i, _hulls.length);
@@ -77,7 +252,204 @@ class ConvexHullDecomposition implements ffi.Finalizable {
       return _hulls[i]!;
     }
     _hulls[i] = ConvexHull._(
-        hacd.bindings.convex_hull_result_get_convex_hull(_native, i));
+        this,
+        ffi.Pointer<hacd.ConvexHull>.fromAddress(_native.ref.hulls.address +
+            ffi.sizeOf<hacd.ConvexHull>() * i));
     return _hulls[i]!;
   }
 }
+
+class ConvexDecompositionMesh {
+  Float32List vertices;
+  Uint32List indices;
+  // Null uses the balanced preset.
+  ConvexDecompositionParameters? parameters;
+
+  ConvexDecompositionMesh(this.vertices, this.indices, [this.parameters]);
+}
+
+// Decomposes many meshes in parallel, one mesh per core at a time.
+class ConvexDecompositionBatch {
+  // One decomposition per input mesh, in order.
+  final List<ConvexHullDecomposition> results;
+  // Worker threads used, including the calling thread.
+  final int threads;
+  final Duration elapsed;
+  final double meshesPerSecond;
+  final double trianglesPerSecond;
+
+  ConvexDecompositionBatch._(this.results, this.threads, this.elapsed,
+      this.meshesPerSecond, this.trianglesPerSecond);
+
+  // Blocks until every mesh is done. Meshes run side by side, so parameters
+  // with async turned off usually scale better.
+  factory ConvexDecompositionBatch(List<ConvexDecompositionMesh> meshes) {
+    final batch = _NativeBatch(meshes);
+    hacd.bindings.compute_convex_hull_batch(
+        batch.meshes, meshes.length, batch.results, batch.stats);
+    return batch.finish();
+  }
+
+  // Like the default constructor but decomposes on native threads, so the
+  // calling isolate keeps running during large imports.
+  static Future<ConvexDecompositionBatch> computeAsync(
+      List<ConvexDecompositionMesh> meshes) {
+    final batch = _NativeBatch(meshes);
+    final completer = Completer<ConvexDecompositionBatch>();
+    final port = RawReceivePort();
+    port.handler = (dynamic message) {
+      port.close();
+      completer.complete(batch.finish());
+    };
+    hacd.bindings.compute_convex_hull_batch_async(batch.meshes, meshes.length,
+        batch.results, batch.stats, port.sendPort.nativePort, 0);
+    return completer.future;
+  }
+}
+
+// Native copies of the inputs and room for the outputs of a batch. Kept
+// alive until the batch is done.
+class _NativeBatch {
+  final int length;
+  final ffi.Pointer<hacd.ConvexHullMesh> meshes;
+  final ffi.Pointer<ffi.Pointer<hacd.ConvexHullResult>> results;
+  final ffi.Pointer<hacd.ConvexHullBatchStats> stats;
+
+  _NativeBatch(List<ConvexDecompositionMesh> meshes)
+      : length = meshes.length,
+        meshes =
+            calloc.allocate(ffi.sizeOf<hacd.ConvexHullMesh>() * meshes.length),
+        results = calloc.allocate(
+            ffi.sizeOf<ffi.Pointer<hacd.ConvexHullResult>>() * meshes.length),
+        stats = calloc.allocate(ffi.sizeOf<hacd.ConvexHullBatchStats>()) {
+    for (int i = 0; i < length; i++) {
+      final mesh = meshes[i];
+      final native = this.meshes[i];
+      final ffi.Pointer<ffi.Float> points =
+          calloc.allocate(ffi.sizeOf<ffi.Float>() * mesh.vertices.length);
+      points.asTypedList(mesh.vertices.length).setAll(0, mesh.vertices);
+      final ffi.Pointer<ffi.Uint32> triangles =
+          calloc.allocate(ffi.sizeOf<ffi.Uint32>() * mesh.indices.length);
+      triangles.asTypedList(mesh.indices.length).setAll(0, mesh.indices);
+      native.points = points;
+      native.num_points = mesh.vertices.length ~/ 3;
+      native.triangles = triangles;
+      native.num_triangles = mesh.indices.length ~/ 3;
+      native.parameters = mesh.parameters?._toNative() ?? ffi.nullptr;
+    }
+  }
+
+  // Wraps the results and frees everything else.
+  ConvexDecompositionBatch finish() {
+    final decompositions = <ConvexHullDecomposition>[
+      for (int i = 0; i < length; i++)
+        ConvexHullDecomposition._fromNative(results[i])
+    ];
+    final batch = ConvexDecompositionBatch._(
+        decompositions,
+        stats.ref.num_threads,
+        Duration(microseconds: (stats.ref.elapsed_ms * 1000).round()),
+        stats.ref.meshes_per_second,
+        stats.ref.triangles_per_second);
+    for (int i = 0; i < length; i++) {
+      calloc.free(meshes[i].points);
+      calloc.free(meshes[i].triangles);
+      if (meshes[i].parameters != ffi.nullptr) {
+        calloc.free(meshes[i].parameters);
+      }
+    }
+    calloc.free(meshes);
+    calloc.free(results);
+    calloc.free(stats);
+    return batch;
+  }
+}
+
+// A decomposition running on a native thread, see
+// [ConvexHullDecompositionJob.start].
+class ConvexHullDecompositionJob implements ffi.Finalizable {
+  static final _finalizer = ffi.NativeFinalizer(
+      hacd.bindings.addresses.destroy_convex_hull_job.cast());
+
+  final ffi.Pointer<hacd.ConvexHullJob> _native;
+  final Completer<ConvexHullDecomposition> _completer;
+
+  ConvexHullDecompositionJob._(this._native, this._completer) {
+    _finalizer.attach(this, _native.cast(), detach: this);
+  }
+
+  static final unwrappedComputeConvexHullAsync = hacd.dylib.lookupFunction<
+      ffi.Pointer<hacd.ConvexHullJob> Function(
+          ffi.Pointer<ffi.Float>,
+          ffi.Int,
+          ffi.Pointer<ffi.Uint32>,
+          ffi.Int,
+          ffi.Pointer<hacd.ConvexHullParameters>,
+          ffi.Int64,
+          ffi.Int64),
+      ffi.Pointer<hacd.ConvexHullJob> Function(
+          Float32List,
+          int,
+          Uint32List,
+          int,
+          ffi.Pointer<hacd.ConvexHullParameters>,
+          int,
+          int)>('compute_convex_hull_async', isLeaf: true);
+
+  // Starts decomposing on a native thread, the inputs are copied before
+  // returning. onProgress is called with the overall progress in percent.
+  factory ConvexHullDecompositionJob.start(
+      Float32List vertices, Uint32List indices,
+      {ConvexDecompositionParameters? parameters,
+      void Function(int percent)? onProgress}) {
+    parameters ??= ConvexDecompositionParameters();
+    final completer = Completer<ConvexHullDecomposition>();
+    final port = RawReceivePort();
+    port.handler = (dynamic message) {
+      // [request id, ConvexHullJobMessage, value].
+      final int type = (message as List)[1];
+      final int value = message[2];
+      switch (type) {
+        case hacd.ConvexHullJobMessage.kConvexHullJobProgress:
+          onProgress?.call(value);
+          return;
+        case hacd.ConvexHullJobMessage.kConvexHullJobDone:
+          port.close();
+          if (value == 0) {
+            completer.completeError(StateError('Decomposition failed'));
+          } else {
+            completer.complete(ConvexHullDecomposition._fromNative(
+                ffi.Pointer<hacd.ConvexHullResult>.fromAddress(value)));
+          }
+          return;
+        case hacd.ConvexHullJobMessage.kConvexHullJobCancelled:
+          port.close();
+          completer.completeError(StateError('Decomposition cancelled'));
+          return;
+      }
+    };
+    final nativeParameters = parameters._toNative();
+    final native = unwrappedComputeConvexHullAsync(
+        vertices,
+        vertices.length ~/ 3,
+        indices,
+        indices.length ~/ 3,
+        nativeParameters,
+        port.sendPort.nativePort,
+        0);
+    calloc.free(nativeParameters);
+    return ConvexHullDecompositionJob._(native, completer);
+  }
+
+  // Completes with the decomposition, or a StateError if it failed or was
+  // cancelled.
+  Future<ConvexHullDecomposition> get result {
+    return _completer.future;
+  }
+
+  // Stops the decomposition at V-HACD's next check, [result] then completes
+  // with an error. Does nothing once the decomposition is done.
+  void cancel() {
+    hacd.bindings.convex_hull_job_cancel(_native);
+  }
+}
@@ -1,7 +1,18 @@
 import 'dart:io';
 import 'dart:ffi' as ffi;
 import 'v-hacd_generated.dart';
-export 'v-hacd_generated.dart' show ConvexHull, ConvexHullResult;
+export 'v-hacd_generated.dart'
+    show
+        ConvexHull,
+        ConvexHullResult,
+        ConvexHullJob,
+        ConvexHullJobMessage,
+        ConvexHullCacheStats,
+        ConvexHullMesh,
+        ConvexHullBatchStats,
+        ConvexHullParameters,
+        ConvexHullFillMode,
+        ConvexHullPreset;
 
 final ffi.DynamicLibrary dylib = () {
   const String _libPath = 'plugins/ffi/v-hacd';
@@ -428,6 +428,244 @@ class VHAVC {
       ffi.Pointer<ConvexHullResult> Function(
           ffi.Pointer<ffi.Float>, int, ffi.Pointer<ffi.Uint32>, int)>();
 
+  ffi.Pointer<ConvexHullResult> compute_convex_hull_with_parameters(
+    ffi.Pointer<ffi.Float> points,
+    int countPoints,
+    ffi.Pointer<ffi.Uint32> triangles,
+    int countTriangles,
+    ffi.Pointer<ConvexHullParameters> parameters,
+  ) {
+    return _compute_convex_hull_with_parameters(
+      points,
+      countPoints,
+      triangles,
+      countTriangles,
+      parameters,
+    );
+  }
+
+  late final _compute_convex_hull_with_parametersPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ConvexHullResult> Function(ffi.Pointer<ffi.Float>,
+              ffi.Uint32,
+              ffi.Pointer<ffi.Uint32>,
+              ffi.Uint32,
+              ffi.Pointer<ConvexHullParameters>)>>('compute_convex_hull_with_parameters');
+  late final _compute_convex_hull_with_parameters = _compute_convex_hull_with_parametersPtr.asFunction<
+      ffi.Pointer<ConvexHullResult> Function(ffi.Pointer<ffi.Float>,
+          int,
+          ffi.Pointer<ffi.Uint32>,
+          int,
+          ffi.Pointer<ConvexHullParameters>)>();
+
+  /// Runs async jobs and the helpers of compute_convex_hull_batch on executor
+  /// instead of on threads of their own, e.g. job_system_run_task from the
+  /// physics plugin to share its worker pool. Null, the default, starts a thread
+  /// per task. Only affects work started afterwards.
+  void convex_hull_set_executor(
+    ConvexHullExecutor executor,
+  ) {
+    return _convex_hull_set_executor(
+      executor,
+    );
+  }
+
+  late final _convex_hull_set_executorPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ConvexHullExecutor)>>(
+          'convex_hull_set_executor');
+  late final _convex_hull_set_executor = _convex_hull_set_executorPtr
+      .asFunction<void Function(ConvexHullExecutor)>();
+
+  ffi.Pointer<ConvexHullResult> compute_single_convex_hull(
+    ffi.Pointer<ffi.Float> points,
+    int countPoints,
+    int max_vertices,
+  ) {
+    return _compute_single_convex_hull(
+      points,
+      countPoints,
+      max_vertices,
+    );
+  }
+
+  late final _compute_single_convex_hullPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ConvexHullResult> Function(ffi.Pointer<ffi.Float>, ffi.Uint32, ffi.Uint32)>>('compute_single_convex_hull');
+  late final _compute_single_convex_hull = _compute_single_convex_hullPtr.asFunction<
+      ffi.Pointer<ConvexHullResult> Function(ffi.Pointer<ffi.Float>, int, int)>();
+
+  void convex_hull_cache_configure(
+    ffi.Pointer<ffi.Char> directory,
+    int max_bytes,
+  ) {
+    return _convex_hull_cache_configure(
+      directory,
+      max_bytes,
+    );
+  }
+
+  late final _convex_hull_cache_configurePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Char>, ffi.Int64)>>('convex_hull_cache_configure');
+  late final _convex_hull_cache_configure = _convex_hull_cache_configurePtr.asFunction<
+      void Function(ffi.Pointer<ffi.Char>, int)>();
+
+  void convex_hull_cache_get_stats(
+    ffi.Pointer<ConvexHullCacheStats> stats,
+  ) {
+    return _convex_hull_cache_get_stats(
+      stats,
+    );
+  }
+
+  late final _convex_hull_cache_get_statsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ConvexHullCacheStats>)>>('convex_hull_cache_get_stats');
+  late final _convex_hull_cache_get_stats = _convex_hull_cache_get_statsPtr.asFunction<
+      void Function(ffi.Pointer<ConvexHullCacheStats>)>();
+
+  void compute_convex_hull_batch(
+    ffi.Pointer<ConvexHullMesh> meshes,
+    int num_meshes,
+    ffi.Pointer<ffi.Pointer<ConvexHullResult>> results,
+    ffi.Pointer<ConvexHullBatchStats> stats,
+  ) {
+    return _compute_convex_hull_batch(
+      meshes,
+      num_meshes,
+      results,
+      stats,
+    );
+  }
+
+  late final _compute_convex_hull_batchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ConvexHullMesh>,
+              ffi.Int,
+              ffi.Pointer<ffi.Pointer<ConvexHullResult>>,
+              ffi.Pointer<ConvexHullBatchStats>)>>('compute_convex_hull_batch');
+  late final _compute_convex_hull_batch = _compute_convex_hull_batchPtr.asFunction<
+      void Function(ffi.Pointer<ConvexHullMesh>,
+          int,
+          ffi.Pointer<ffi.Pointer<ConvexHullResult>>,
+          ffi.Pointer<ConvexHullBatchStats>)>();
+
+  void compute_convex_hull_batch_async(
+    ffi.Pointer<ConvexHullMesh> meshes,
+    int num_meshes,
+    ffi.Pointer<ffi.Pointer<ConvexHullResult>> results,
+    ffi.Pointer<ConvexHullBatchStats> stats,
+    int port,
+    int request_id,
+  ) {
+    return _compute_convex_hull_batch_async(
+      meshes,
+      num_meshes,
+      results,
+      stats,
+      port,
+      request_id,
+    );
+  }
+
+  late final _compute_convex_hull_batch_asyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ConvexHullMesh>,
+              ffi.Int,
+              ffi.Pointer<ffi.Pointer<ConvexHullResult>>,
+              ffi.Pointer<ConvexHullBatchStats>,
+              Dart_Port_DL,
+              ffi.Int64)>>('compute_convex_hull_batch_async');
+  late final _compute_convex_hull_batch_async = _compute_convex_hull_batch_asyncPtr.asFunction<
+      void Function(ffi.Pointer<ConvexHullMesh>,
+          int,
+          ffi.Pointer<ffi.Pointer<ConvexHullResult>>,
+          ffi.Pointer<ConvexHullBatchStats>,
+          int,
+          int)>();
+
+  void convex_hull_parameters_preset(
+    int preset,
+    ffi.Pointer<ConvexHullParameters> parameters,
+  ) {
+    return _convex_hull_parameters_preset(
+      preset,
+      parameters,
+    );
+  }
+
+  late final _convex_hull_parameters_presetPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Int, ffi.Pointer<ConvexHullParameters>)>>('convex_hull_parameters_preset');
+  late final _convex_hull_parameters_preset = _convex_hull_parameters_presetPtr.asFunction<
+      void Function(int, ffi.Pointer<ConvexHullParameters>)>();
+
+  ffi.Pointer<ConvexHullJob> compute_convex_hull_async(
+    ffi.Pointer<ffi.Float> points,
+    int countPoints,
+    ffi.Pointer<ffi.Uint32> triangles,
+    int countTriangles,
+    ffi.Pointer<ConvexHullParameters> parameters,
+    int port,
+    int request_id,
+  ) {
+    return _compute_convex_hull_async(
+      points,
+      countPoints,
+      triangles,
+      countTriangles,
+      parameters,
+      port,
+      request_id,
+    );
+  }
+
+  late final _compute_convex_hull_asyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ConvexHullJob> Function(ffi.Pointer<ffi.Float>,
+              ffi.Uint32,
+              ffi.Pointer<ffi.Uint32>,
+              ffi.Uint32,
+              ffi.Pointer<ConvexHullParameters>,
+              Dart_Port_DL,
+              ffi.Int64)>>('compute_convex_hull_async');
+  late final _compute_convex_hull_async = _compute_convex_hull_asyncPtr.asFunction<
+      ffi.Pointer<ConvexHullJob> Function(ffi.Pointer<ffi.Float>,
+          int,
+          ffi.Pointer<ffi.Uint32>,
+          int,
+          ffi.Pointer<ConvexHullParameters>,
+          int,
+          int)>();
+
+  void convex_hull_job_cancel(
+    ffi.Pointer<ConvexHullJob> job,
+  ) {
+    return _convex_hull_job_cancel(
+      job,
+    );
+  }
+
+  late final _convex_hull_job_cancelPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ConvexHullJob>)>>('convex_hull_job_cancel');
+  late final _convex_hull_job_cancel = _convex_hull_job_cancelPtr.asFunction<
+      void Function(ffi.Pointer<ConvexHullJob>)>();
+
+  void destroy_convex_hull_job(
+    ffi.Pointer<ConvexHullJob> job,
+  ) {
+    return _destroy_convex_hull_job(
+      job,
+    );
+  }
+
+  late final _destroy_convex_hull_jobPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ConvexHullJob>)>>('destroy_convex_hull_job');
+  late final _destroy_convex_hull_job = _destroy_convex_hull_jobPtr.asFunction<
+      void Function(ffi.Pointer<ConvexHullJob>)>();
+
   void destroy_convex_hull_result(
     ffi.Pointer<ConvexHullResult> result,
   ) {
@@ -574,6 +812,66 @@ class _SymbolAddresses {
               ffi.Pointer<ffi.Uint32>,
               ffi.Uint32)>> get compute_convex_hull =>
       _library._compute_convex_hullPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<ConvexHullResult> Function(ffi.Pointer<ffi.Float>,
+              ffi.Uint32,
+              ffi.Pointer<ffi.Uint32>,
+              ffi.Uint32,
+              ffi.Pointer<ConvexHullParameters>)>>
+      get compute_convex_hull_with_parameters => _library._compute_convex_hull_with_parametersPtr;
+  ffi.Pointer<ffi.NativeFunction<ffi.Void Function(ConvexHullExecutor)>>
+      get convex_hull_set_executor => _library._convex_hull_set_executorPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<ConvexHullResult> Function(ffi.Pointer<ffi.Float>, ffi.Uint32, ffi.Uint32)>>
+      get compute_single_convex_hull => _library._compute_single_convex_hullPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ffi.Char>, ffi.Int64)>>
+      get convex_hull_cache_configure => _library._convex_hull_cache_configurePtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ConvexHullCacheStats>)>>
+      get convex_hull_cache_get_stats => _library._convex_hull_cache_get_statsPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ConvexHullMesh>,
+              ffi.Int,
+              ffi.Pointer<ffi.Pointer<ConvexHullResult>>,
+              ffi.Pointer<ConvexHullBatchStats>)>>
+      get compute_convex_hull_batch => _library._compute_convex_hull_batchPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ConvexHullMesh>,
+              ffi.Int,
+              ffi.Pointer<ffi.Pointer<ConvexHullResult>>,
+              ffi.Pointer<ConvexHullBatchStats>,
+              Dart_Port_DL,
+              ffi.Int64)>>
+      get compute_convex_hull_batch_async => _library._compute_convex_hull_batch_asyncPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Int, ffi.Pointer<ConvexHullParameters>)>>
+      get convex_hull_parameters_preset => _library._convex_hull_parameters_presetPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Pointer<ConvexHullJob> Function(ffi.Pointer<ffi.Float>,
+              ffi.Uint32,
+              ffi.Pointer<ffi.Uint32>,
+              ffi.Uint32,
+              ffi.Pointer<ConvexHullParameters>,
+              Dart_Port_DL,
+              ffi.Int64)>>
+      get compute_convex_hull_async => _library._compute_convex_hull_asyncPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ConvexHullJob>)>>
+      get convex_hull_job_cancel => _library._convex_hull_job_cancelPtr;
+  ffi.Pointer<
+          ffi.NativeFunction<
+              ffi.Void Function(ffi.Pointer<ConvexHullJob>)>>
+      get destroy_convex_hull_job => _library._destroy_convex_hull_jobPtr;
   ffi.Pointer<
           ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ConvexHullResult>)>>
       get destroy_convex_hull_result => _library._destroy_convex_hull_resultPtr;
@@ -1063,4 +1361,157 @@ final class ConvexHull extends ffi.Struct {
   external double volume;
 }
 
-final class ConvexHullResult extends ffi.Opaque {}
+abstract class ConvexHullFillMode {
+  /// Flood fill the voxels outside the mesh, everything else is interior.
+  static const int kConvexHullFillFlood = 0;
+
+  /// Only voxelize the surface, for meshes that are not closed.
+  static const int kConvexHullFillSurfaceOnly = 1;
+
+  /// Find interior voxels with raycasts, for meshes with small holes.
+  static const int kConvexHullFillRaycast = 2;
+}
+
+final class ConvexHullParameters extends ffi.Struct {
+  /// Upper bound on the number of convex hulls.
+  @ffi.Uint32()
+  external int max_convex_hulls;
+
+  /// Number of voxels used to approximate the mesh.
+  @ffi.Uint32()
+  external int resolution;
+
+  /// Upper bound on the vertices of each hull.
+  @ffi.Uint32()
+  external int max_vertices_per_hull;
+
+  /// Stop splitting a hull once its volume is within this percentage of the
+  /// voxels it covers.
+  @ffi.Double()
+  external double min_volume_percent_error;
+
+  /// Upper bound on how often hulls are split.
+  @ffi.Uint32()
+  external int max_recursion_depth;
+
+  /// ConvexHullFillMode.
+  @ffi.Int()
+  external int fill_mode;
+
+  /// Split hulls on several threads.
+  @ffi.Bool()
+  external bool async;
+}
+
+/// Trade decomposition time for fidelity. kConvexHullPresetBalanced matches
+/// the V-HACD defaults.
+abstract class ConvexHullPreset {
+  static const int kConvexHullPresetPreview = 0;
+  static const int kConvexHullPresetFast = 1;
+  static const int kConvexHullPresetBalanced = 2;
+  static const int kConvexHullPresetHigh = 3;
+}
+
+/// A decomposition packed into one allocation: this header, then the hulls
+/// table, then the vertices of every hull back to back, then their indices.
+/// The vertices and indices of each ConvexHull point into the shared arrays.
+final class ConvexHullResult extends ffi.Struct {
+  @ffi.Uint32()
+  external int num_hulls;
+
+  /// Number of floats in vertices.
+  @ffi.Uint32()
+  external int vertices_size;
+
+  /// Number of uint32_ts in indices.
+  @ffi.Uint32()
+  external int indices_size;
+
+  /// Non-zero when the result is a mapped cache file instead of a malloc block.
+  @ffi.Uint32()
+  external int mapped;
+
+  /// Bytes in the whole allocation.
+  @ffi.Uint64()
+  external int size;
+
+  external ffi.Pointer<ConvexHull> hulls;
+
+  external ffi.Pointer<ffi.Float> vertices;
+
+  external ffi.Pointer<ffi.Uint32> indices;
+}
+
+final class ConvexHullJob extends ffi.Opaque {}
+
+/// One input of compute_convex_hull_batch.
+final class ConvexHullMesh extends ffi.Struct {
+  external ffi.Pointer<ffi.Float> points;
+
+  @ffi.Uint32()
+  external int num_points;
+
+  external ffi.Pointer<ffi.Uint32> triangles;
+
+  @ffi.Uint32()
+  external int num_triangles;
+
+  /// Null uses kConvexHullPresetBalanced.
+  external ffi.Pointer<ConvexHullParameters> parameters;
+}
+
+final class ConvexHullBatchStats extends ffi.Struct {
+  /// Worker threads used, including the calling thread.
+  @ffi.Int()
+  external int num_threads;
+
+  @ffi.Double()
+  external double elapsed_ms;
+
+  @ffi.Double()
+  external double meshes_per_second;
+
+  @ffi.Double()
+  external double triangles_per_second;
+}
+
+final class ConvexHullCacheStats extends ffi.Struct {
+  /// compute_convex_hull* calls answered from the cache.
+  @ffi.Int64()
+  external int hits;
+
+  /// compute_convex_hull* calls that ran V-HACD and stored their result.
+  @ffi.Int64()
+  external int misses;
+
+  /// Results deleted to stay under the size limit.
+  @ffi.Int64()
+  external int evictions;
+}
+
+abstract class ConvexHullJobMessage {
+  /// value is the overall progress in percent.
+  static const int kConvexHullJobProgress = 0;
+
+  /// value is the ConvexHullResult* address, 0 if the decomposition failed.
+  /// The receiver owns the result.
+  static const int kConvexHullJobDone = 1;
+
+  /// value is 0.
+  static const int kConvexHullJobCancelled = 2;
+}
+
+/// Unit of work handed to a ConvexHullExecutor.
+typedef ConvexHullTask
+    = ffi.Pointer<ffi.NativeFunction<ConvexHullTaskFunction>>;
+typedef ConvexHullTaskFunction = ffi.Void Function(ffi.Pointer<ffi.Void> data);
+typedef DartConvexHullTaskFunction = void Function(ffi.Pointer<ffi.Void> data);
+
+/// Runs task(data) on some thread, eventually. Must not run it inline on the
+/// calling thread.
+typedef ConvexHullExecutor
+    = ffi.Pointer<ffi.NativeFunction<ConvexHullExecutorFunction>>;
+typedef ConvexHullExecutorFunction = ffi.Void Function(
+    ConvexHullTask task, ffi.Pointer<ffi.Void> data);
+typedef DartConvexHullExecutorFunction = void Function(
+    ConvexHullTask task, ffi.Pointer<ffi.Void> data);
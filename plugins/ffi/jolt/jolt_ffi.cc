@@ -2,8 +2,32 @@
 #include "dart_api.h"
 #include "dart_api_dl.h"
 
+#if !_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
+#if __linux__
+#include <sys/syscall.h>
+#endif
+#if __APPLE__
+#include <pthread/qos.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cfloat>
+#include <condition_variable>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <string_view>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 // The Jolt headers don't include Jolt.h. Always include Jolt.h before including
 // any other Jolt header. You can use Jolt.h in your precompiled header to speed
@@ -14,6 +38,8 @@
 #include <Jolt/Core/Factory.h>
 #include <Jolt/Core/JobSystemSingleThreaded.h>
 #include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/StreamIn.h>
+#include <Jolt/Core/StreamOut.h>
 #include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Geometry/Indexify.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
@@ -23,6 +49,8 @@
 #include <Jolt/Physics/Collision/BroadPhase/ObjectVsBroadPhaseLayerFilterMask.h>
 #include <Jolt/Physics/Collision/ObjectLayerPairFilterMask.h>
 #include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+#include <Jolt/Physics/Collision/ContactListener.h>
 #include <Jolt/Physics/Collision/RayCast.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
@@ -33,12 +61,17 @@
 #include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
 #include <Jolt/Physics/Collision/Shape/MeshShape.h>
 #include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
+#include <Jolt/Physics/Collision/PhysicsMaterial.h>
 #include <Jolt/Physics/EActivation.h>
 #include <Jolt/Physics/PhysicsSettings.h>
 #include <Jolt/Physics/PhysicsSystem.h>
 #include <Jolt/RegisterTypes.h>
 #include <Jolt/Physics/Body/BodyLock.h>
 
+#define ENABLE_VHACD_IMPLEMENTATION 1
+
+#include "VHACD.h"
+
 // Disable common warnings triggered by Jolt, you can use
 // JPH_SUPPRESS_WARNING_PUSH / JPH_SUPPRESS_WARNING_POP to store and restore the
 // warning state
@@ -79,18 +112,494 @@ FFI_PLUGIN_EXPORT void native_free(void* p) {
   free(p);
 }
 
+// Owns the memory behind a TransformMirror. The arrays are allocated once so
+// views created on the Dart side stay valid for the lifetime of the World.
+class TransformMirrorStorage {
+public:
+  static constexpr int kMirrorBuffers = 3;
+
+  TransformMirrorStorage(int capacity, bool matrices) {
+    mirror_.generation = 0;
+    mirror_.capacity = capacity;
+    for (int i = 0; i < kMirrorBuffers; i++) {
+      mirror_.positions[i] = AllocateFloats(capacity * 4);
+      mirror_.rotations[i] = AllocateFloats(capacity * 4);
+      mirror_.matrices[i] = matrices ? AllocateFloats(capacity * 16) : nullptr;
+    }
+  }
+
+  ~TransformMirrorStorage() {
+    for (int i = 0; i < kMirrorBuffers; i++) {
+      AlignedFree(mirror_.positions[i]);
+      AlignedFree(mirror_.rotations[i]);
+      if (mirror_.matrices[i] != nullptr) {
+        AlignedFree(mirror_.matrices[i]);
+      }
+    }
+  }
+
+  TransformMirror *mirror() { return &mirror_; }
+
+  // Published by the last step.
+  int current() const { return static_cast<int>(mirror_.generation % kMirrorBuffers); }
+
+  // Written by the step in flight. Neither the current nor the previous
+  // buffer is touched, so readers can interpolate while a step runs.
+  int next() const { return static_cast<int>((mirror_.generation + 1) % kMirrorBuffers); }
+
+  bool HasSlot(int slot) const { return slot >= 0 && slot < mirror_.capacity; }
+
+  void Write(int buffer, int slot, const Body &body) {
+    *reinterpret_cast<Vec3 *>(&mirror_.positions[buffer][slot * 4]) = body.GetPosition();
+    *reinterpret_cast<Quat *>(&mirror_.rotations[buffer][slot * 4]) = body.GetRotation();
+    if (mirror_.matrices[buffer] != nullptr) {
+      *reinterpret_cast<Mat44 *>(&mirror_.matrices[buffer][slot * 16]) = body.GetWorldTransform();
+    }
+  }
+
+  // Seeds the next buffer with the current one so bodies that don't move keep
+  // their transform across the swap.
+  void CopyCurrentToNext(int num_slots) {
+    num_slots = std::min(num_slots, mirror_.capacity);
+    int f = current();
+    int b = next();
+    memcpy(mirror_.positions[b], mirror_.positions[f], num_slots * 4 * sizeof(float));
+    memcpy(mirror_.rotations[b], mirror_.rotations[f], num_slots * 4 * sizeof(float));
+    if (mirror_.matrices[b] != nullptr) {
+      memcpy(mirror_.matrices[b], mirror_.matrices[f], num_slots * 16 * sizeof(float));
+    }
+  }
+
+  void Swap() {
+    // Publish the next buffer before readers can observe the new generation.
+    std::atomic_thread_fence(std::memory_order_release);
+    mirror_.generation++;
+  }
+
+private:
+  static float *AllocateFloats(int count) {
+    float *p = static_cast<float *>(AlignedAllocate(count * sizeof(float), 16));
+    memset(p, 0, count * sizeof(float));
+    return p;
+  }
+
+  TransformMirror mirror_;
+};
+
+// Records contact events into a preallocated buffer from the physics worker
+// threads. Only pairs where at least one body opted in are recorded.
+class ContactEventRecorder : public ContactListener {
+public:
+  ContactEventRecorder(int capacity, const std::vector<uint8_t> *opt_in)
+      : events_(capacity), opt_in_(opt_in) {
+    buffer_.events = events_.data();
+    buffer_.capacity = capacity;
+    buffer_.count = 0;
+    buffer_.dropped = 0;
+  }
+
+  ContactEventBuffer *buffer() { return &buffer_; }
+
+  // Called before the first update of a step.
+  void Begin() { next_.store(0, std::memory_order_relaxed); }
+
+  // Called after the last update of a step. Publishes the count.
+  void End() {
+    int recorded = static_cast<int>(next_.load(std::memory_order_acquire));
+    buffer_.count = std::min(recorded, buffer_.capacity);
+    buffer_.dropped = recorded - buffer_.count;
+  }
+
+  void OnContactAdded(const Body &inBody1, const Body &inBody2,
+                      const ContactManifold &inManifold,
+                      ContactSettings &ioSettings) override {
+    Record(kContactAdded, inBody1, inBody2, inManifold);
+  }
+
+  void OnContactPersisted(const Body &inBody1, const Body &inBody2,
+                          const ContactManifold &inManifold,
+                          ContactSettings &ioSettings) override {
+    Record(kContactPersisted, inBody1, inBody2, inManifold);
+  }
+
+  void OnContactRemoved(const SubShapeIDPair &inSubShapePair) override {
+    if (!WantsEvents(inSubShapePair.GetBody1ID(), inSubShapePair.GetBody2ID())) {
+      return;
+    }
+    ContactEvent *event = Append();
+    if (event == nullptr) {
+      return;
+    }
+    event->type = kContactRemoved;
+    event->body_index1 = inSubShapePair.GetBody1ID().GetIndex();
+    event->body_index2 = inSubShapePair.GetBody2ID().GetIndex();
+    event->sub_shape_id1 = inSubShapePair.GetSubShapeID1().GetValue();
+    event->sub_shape_id2 = inSubShapePair.GetSubShapeID2().GetValue();
+    memset(event->point, 0, sizeof(event->point));
+    memset(event->normal, 0, sizeof(event->normal));
+    event->impulse = 0.0f;
+  }
+
+private:
+  bool WantsEvents(const BodyID &id) const {
+    return id.GetIndex() < opt_in_->size() && (*opt_in_)[id.GetIndex()] != 0;
+  }
+
+  bool WantsEvents(const BodyID &id1, const BodyID &id2) const {
+    return WantsEvents(id1) || WantsEvents(id2);
+  }
+
+  ContactEvent *Append() {
+    uint32_t index = next_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= events_.size()) {
+      // Buffer is full, the event is counted as dropped.
+      return nullptr;
+    }
+    return &events_[index];
+  }
+
+  // Velocity of a body at a world space point.
+  static Vec3 GetPointVelocity(const Body &body, RVec3Arg point) {
+    if (body.IsStatic()) {
+      return Vec3::sZero();
+    }
+    return body.GetPointVelocity(point);
+  }
+
+  static float GetInverseMass(const Body &body) {
+    if (!body.IsDynamic()) {
+      return 0.0f;
+    }
+    return body.GetMotionProperties()->GetInverseMass();
+  }
+
+  void Record(ContactEventType type, const Body &body1, const Body &body2,
+              const ContactManifold &manifold) {
+    if (!WantsEvents(body1.GetID(), body2.GetID())) {
+      return;
+    }
+    ContactEvent *event = Append();
+    if (event == nullptr) {
+      return;
+    }
+    RVec3 point = manifold.GetWorldSpaceContactPointOn1(0);
+    Vec3 normal = manifold.mWorldSpaceNormal;
+    event->type = type;
+    event->body_index1 = body1.GetID().GetIndex();
+    event->body_index2 = body2.GetID().GetIndex();
+    event->sub_shape_id1 = manifold.mSubShapeID1.GetValue();
+    event->sub_shape_id2 = manifold.mSubShapeID2.GetValue();
+    event->point[0] = static_cast<float>(point.GetX());
+    event->point[1] = static_cast<float>(point.GetY());
+    event->point[2] = static_cast<float>(point.GetZ());
+    event->normal[0] = normal.GetX();
+    event->normal[1] = normal.GetY();
+    event->normal[2] = normal.GetZ();
+    // The solver hasn't run yet so estimate the impulse needed to stop the
+    // bodies from approaching each other, ignoring rotational inertia.
+    float approach_speed = (GetPointVelocity(body1, point) - GetPointVelocity(body2, point)).Dot(normal);
+    float inverse_mass = GetInverseMass(body1) + GetInverseMass(body2);
+    event->impulse = (approach_speed > 0.0f && inverse_mass > 0.0f) ? approach_speed / inverse_mass : 0.0f;
+  }
+
+  std::vector<ContactEvent> events_;
+  const std::vector<uint8_t> *opt_in_;
+  std::atomic<uint32_t> next_{0};
+  ContactEventBuffer buffer_;
+};
+
+// Tracks which bodies overlap sensor bodies. Sensors report one contact per
+// pair of sub shapes so overlaps are reference counted per body pair and only
+// the first contact and the last removal are reported.
+class SensorTracker : public ContactListener {
+public:
+  SensorTracker() { Publish(); }
+
+  SensorEvents *events() { return &events_; }
+
+  void OnContactAdded(const Body &inBody1, const Body &inBody2,
+                      const ContactManifold &inManifold,
+                      ContactSettings &ioSettings) override {
+    if (!inBody1.IsSensor() && !inBody2.IsSensor()) {
+      return;
+    }
+    const Body &sensor = inBody1.IsSensor() ? inBody1 : inBody2;
+    const Body &other = inBody1.IsSensor() ? inBody2 : inBody1;
+    std::lock_guard<std::mutex> lock(mutex_);
+    Overlap &overlap = overlaps_[Key(inBody1.GetID(), inBody2.GetID())];
+    if (overlap.contacts++ == 0) {
+      overlap.sensor_index = sensor.GetID().GetIndex();
+      overlap.other_index = other.GetID().GetIndex();
+      pending_.push_back({kSensorEnter, overlap.sensor_index, overlap.other_index});
+    }
+  }
+
+  void OnContactRemoved(const SubShapeIDPair &inSubShapePair) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // The bodies may already be gone so sensor pairs are found by key.
+    auto it = overlaps_.find(Key(inSubShapePair.GetBody1ID(), inSubShapePair.GetBody2ID()));
+    if (it == overlaps_.end()) {
+      return;
+    }
+    if (--it->second.contacts == 0) {
+      pending_.push_back({kSensorExit, it->second.sensor_index, it->second.other_index});
+      overlaps_.erase(it);
+    }
+  }
+
+  // Called at the end of every step. Makes the events since the previous call
+  // visible through events().
+  void Publish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    published_.swap(pending_);
+    pending_.clear();
+    events_.events = published_.data();
+    events_.count = static_cast<int>(published_.size());
+  }
+
+private:
+  struct Overlap {
+    int contacts = 0;
+    uint32_t sensor_index = 0;
+    uint32_t other_index = 0;
+  };
+
+  static uint64_t Key(const BodyID &id1, const BodyID &id2) {
+    uint64_t a = id1.GetIndexAndSequenceNumber();
+    uint64_t b = id2.GetIndexAndSequenceNumber();
+    return a < b ? (a << 32) | b : (b << 32) | a;
+  }
+
+  std::mutex mutex_;
+  std::unordered_map<uint64_t, Overlap> overlaps_;
+  std::vector<SensorEvent> pending_;
+  std::vector<SensorEvent> published_;
+  SensorEvents events_;
+};
+
+// Forwards contact callbacks to every listener enabled on a world, since
+// PhysicsSystem only takes a single ContactListener.
+class ContactListenerList : public ContactListener {
+public:
+  void Add(ContactListener *listener) { listeners_.push_back(listener); }
+
+  void OnContactAdded(const Body &inBody1, const Body &inBody2,
+                      const ContactManifold &inManifold,
+                      ContactSettings &ioSettings) override {
+    for (ContactListener *listener : listeners_) {
+      listener->OnContactAdded(inBody1, inBody2, inManifold, ioSettings);
+    }
+  }
+
+  void OnContactPersisted(const Body &inBody1, const Body &inBody2,
+                          const ContactManifold &inManifold,
+                          ContactSettings &ioSettings) override {
+    for (ContactListener *listener : listeners_) {
+      listener->OnContactPersisted(inBody1, inBody2, inManifold, ioSettings);
+    }
+  }
+
+  void OnContactRemoved(const SubShapeIDPair &inSubShapePair) override {
+    for (ContactListener *listener : listeners_) {
+      listener->OnContactRemoved(inSubShapePair);
+    }
+  }
+
+private:
+  std::vector<ContactListener *> listeners_;
+};
+
+// Keeps a bitmap of active bodies and lists of the bodies that changed state.
+// Jolt calls the listener from the physics worker threads while the body is
+// locked, so the bitmap is updated atomically and the lists take a mutex.
+class ActivationTracker : public BodyActivationListener {
+public:
+  explicit ActivationTracker(uint32_t max_bodies)
+      : bits_((max_bodies + 63) / 64) {
+    static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t),
+                  "active_bits is read as plain uint64_t");
+    events_.active_bits = reinterpret_cast<uint64_t *>(bits_.data());
+    events_.num_words = static_cast<int>(bits_.size());
+    Publish();
+  }
+
+  ActivationEvents *events() { return &events_; }
+
+  // Marks bodies that were already active before the tracker was installed.
+  void Seed(const BodyIDVector &active) {
+    for (const BodyID &id : active) {
+      SetBit(id.GetIndex(), true);
+    }
+  }
+
+  void OnBodyActivated(const BodyID &inBodyID, uint64 inBodyUserData) override {
+    SetBit(inBodyID.GetIndex(), true);
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_activated_.push_back(inBodyID.GetIndex());
+  }
+
+  void OnBodyDeactivated(const BodyID &inBodyID, uint64 inBodyUserData) override {
+    SetBit(inBodyID.GetIndex(), false);
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_deactivated_.push_back(inBodyID.GetIndex());
+  }
+
+  // Called at the end of every step. Makes the changes since the previous
+  // call visible through events().
+  void Publish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    activated_.swap(pending_activated_);
+    deactivated_.swap(pending_deactivated_);
+    pending_activated_.clear();
+    pending_deactivated_.clear();
+    events_.activated = activated_.data();
+    events_.num_activated = static_cast<int>(activated_.size());
+    events_.deactivated = deactivated_.data();
+    events_.num_deactivated = static_cast<int>(deactivated_.size());
+  }
+
+private:
+  void SetBit(uint32_t index, bool active) {
+    uint64_t mask = uint64_t(1) << (index & 63);
+    if (active) {
+      bits_[index >> 6].fetch_or(mask, std::memory_order_relaxed);
+    } else {
+      bits_[index >> 6].fetch_and(~mask, std::memory_order_relaxed);
+    }
+  }
+
+  std::vector<std::atomic<uint64_t>> bits_;
+  std::mutex mutex_;
+  std::vector<uint32_t> pending_activated_;
+  std::vector<uint32_t> pending_deactivated_;
+  std::vector<uint32_t> activated_;
+  std::vector<uint32_t> deactivated_;
+  ActivationEvents events_;
+};
+
+// Best effort, raising the priority usually needs extra privileges and is
+// then silently skipped.
+static void SetCurrentThreadPriority(int priority) {
+#if _WIN32
+  int value = THREAD_PRIORITY_NORMAL;
+  if (priority == kJobPriorityLow) {
+    value = THREAD_PRIORITY_BELOW_NORMAL;
+  } else if (priority == kJobPriorityHigh) {
+    value = THREAD_PRIORITY_ABOVE_NORMAL;
+  }
+  SetThreadPriority(GetCurrentThread(), value);
+#elif __APPLE__
+  qos_class_t qos = QOS_CLASS_USER_INITIATED;
+  if (priority == kJobPriorityLow) {
+    qos = QOS_CLASS_UTILITY;
+  } else if (priority == kJobPriorityHigh) {
+    qos = QOS_CLASS_USER_INTERACTIVE;
+  }
+  pthread_set_qos_class_self_np(qos, 0);
+#elif __linux__
+  // Linux applies nice values per thread.
+  int nice = 0;
+  if (priority == kJobPriorityLow) {
+    nice = 10;
+  } else if (priority == kJobPriorityHigh) {
+    nice = -5;
+  }
+  setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice);
+#endif
+}
+
+// Worker pool shared by every world that doesn't ask for threads of its own,
+// by async shape construction and by job_system_run_task, so that the total
+// number of threads stays bounded however many worlds exist. Idle workers
+// sleep. Created on first use and intentionally never destroyed so that exit
+// doesn't wait on it.
+class SharedJobSystem {
+public:
+  // Room for several worlds stepping at the same time.
+  static constexpr int kMaxJobs = cMaxPhysicsJobs * 4;
+  static constexpr int kMaxBarriers = cMaxPhysicsBarriers * 8;
+
+  static SharedJobSystem &Get() {
+    static SharedJobSystem *shared = new SharedJobSystem();
+    return *shared;
+  }
+
+  // Resizing a live pool joins its workers and runs the queued jobs on the
+  // calling thread, which is not safe while other threads queue jobs or wait
+  // on barriers. So the settings only apply before the pool starts.
+  bool Configure(int num_threads, int priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pool_ != nullptr) {
+      return false;
+    }
+    num_threads_ = ResolveNumThreads(num_threads);
+    priority_ = priority;
+    return true;
+  }
+
+  JobSystem *job_system() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pool_ == nullptr) {
+      init_jph_once();
+      pool_ = new JobSystemThreadPool();
+      pool_->SetThreadInitFunction([this](int) { SetCurrentThreadPriority(priority_); });
+      pool_->Init(kMaxJobs, kMaxBarriers, num_threads_);
+    }
+    return pool_;
+  }
+
+private:
+  // Jobs that nobody waits on, like the async shapes, only run on workers, so
+  // keep at least one.
+  static int ResolveNumThreads(int num_threads) {
+    if (num_threads < 0) {
+      num_threads = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+    }
+    return std::max(num_threads, 1);
+  }
+
+  std::mutex mutex_;
+  JobSystemThreadPool *pool_ = nullptr;
+  int num_threads_ = ResolveNumThreads(-1);
+  std::atomic<int> priority_{kJobPriorityNormal};
+};
+
 class World {
 public:
-  World() {
-    temp_allocator_ = std::make_unique<TempAllocatorImpl>(10 * 1024 * 1024);
-    job_system_ = std::make_unique<JobSystemThreadPool>(cMaxPhysicsJobs, cMaxPhysicsBarriers, thread::hardware_concurrency() - 1);
+  explicit World(const WorldConfig &config) {
+    temp_allocator_ = std::make_unique<TempAllocatorImpl>(config.temp_allocator_size);
+    if (config.num_threads < 0) {
+      job_system_ = SharedJobSystem::Get().job_system();
+    } else if (config.num_threads == 0) {
+      // Avoid spinning up a thread pool for tiny worlds.
+      owned_job_system_ = std::make_unique<JobSystemSingleThreaded>(cMaxPhysicsJobs);
+      job_system_ = owned_job_system_.get();
+    } else {
+      owned_job_system_ = std::make_unique<JobSystemThreadPool>(cMaxPhysicsJobs, cMaxPhysicsBarriers, config.num_threads);
+      job_system_ = owned_job_system_.get();
+    }
 
     // Configure our broad phase layers.
-    bp_layer_interface_ = std::make_unique<BroadPhaseLayerInterfaceMask>(2);
-    // Layer 0 holds moving and sensor objects.
-    bp_layer_interface_->ConfigureLayer(BroadPhaseLayer(0), LayerFilterMoving|LayerFilterSensor, 0);
-    // Layer 1 holds static objects.
-    bp_layer_interface_->ConfigureLayer(BroadPhaseLayer(1), LayerFilterStatic, 0);
+    switch (std::clamp(config.num_broad_phase_layers, 1, 3)) {
+      case 1:
+        // Layer 0 holds everything.
+        bp_layer_interface_ = std::make_unique<BroadPhaseLayerInterfaceMask>(1);
+        bp_layer_interface_->ConfigureLayer(BroadPhaseLayer(0), LayerFilterAll, 0);
+        break;
+      case 2:
+        bp_layer_interface_ = std::make_unique<BroadPhaseLayerInterfaceMask>(2);
+        // Layer 0 holds moving and sensor objects.
+        bp_layer_interface_->ConfigureLayer(BroadPhaseLayer(0), LayerFilterMoving|LayerFilterSensor, 0);
+        // Layer 1 holds static objects.
+        bp_layer_interface_->ConfigureLayer(BroadPhaseLayer(1), LayerFilterStatic, 0);
+        break;
+      case 3:
+        bp_layer_interface_ = std::make_unique<BroadPhaseLayerInterfaceMask>(3);
+        bp_layer_interface_->ConfigureLayer(BroadPhaseLayer(0), LayerFilterMoving, 0);
+        bp_layer_interface_->ConfigureLayer(BroadPhaseLayer(1), LayerFilterStatic, 0);
+        bp_layer_interface_->ConfigureLayer(BroadPhaseLayer(2), LayerFilterSensor, 0);
+        break;
+    }
 
     object_vs_broad_phase_layer_filter_ =
         std::make_unique<ObjectVsBroadPhaseLayerFilterMask>(
@@ -99,17 +608,28 @@ public:
     object_vs_object_layer_pair_filter_ =
         std::make_unique<ObjectLayerPairFilterMask>();
     physics_system_ = std::make_unique<PhysicsSystem>();
-    physics_system_->Init(cMaxBodies, cNumBodyMutexes, cMaxBodyPairs,
-                          cMaxContactConstraints, *bp_layer_interface_,
+    physics_system_->Init(config.max_bodies, config.num_body_mutexes,
+                          config.max_body_pairs,
+                          config.max_contact_constraints, *bp_layer_interface_,
                           *object_vs_broad_phase_layer_filter_,
                           *object_vs_object_layer_pair_filter_);
+    physics_system_->SetGravity(Vec3(config.gravity[0], config.gravity[1], config.gravity[2]));
   }
 
-  ~World() { }
+  ~World() {
+    if (step_thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(step_mutex_);
+        step_thread_exit_ = true;
+      }
+      step_cv_.notify_all();
+      step_thread_.join();
+    }
+  }
 
   TempAllocator *temp_allocator() { return temp_allocator_.get(); }
 
-  JobSystem *job_system() { return job_system_.get(); }
+  JobSystem *job_system() { return job_system_; }
 
   PhysicsSystem &physics_system() { return *physics_system_; }
 
@@ -121,56 +641,330 @@ public:
     return physics_system_->GetBodyInterface();
   }
 
+  const StepConfig &step_config() const { return step_config_; }
+
+  void SetStepConfig(const StepConfig &config) {
+    step_config_ = config;
+    step_config_.max_substeps = std::max(step_config_.max_substeps, 1);
+    step_config_.collision_steps = std::max(step_config_.collision_steps, 1);
+    accumulator_ = 0.0f;
+  }
+
+  float interpolation_alpha() const {
+    if (step_config_.fixed_dt <= 0.0f) {
+      return 1.0f;
+    }
+    return accumulator_ / step_config_.fixed_dt;
+  }
+
+  // Runs one PhysicsSystem::Update and publishes the result to the mirror.
+  EPhysicsUpdateError Update(float dt) {
+    BeginMirrorUpdate();
+    EPhysicsUpdateError error = physics_system_->Update(
+        dt, step_config_.collision_steps, temp_allocator(), job_system());
+    EndMirrorUpdate();
+    return error;
+  }
+
+  // Advances the simulation by dt. In fixed step mode dt is added to the
+  // accumulator and as many fixed updates as fit are run, up to max_substeps.
+  EPhysicsUpdateError Step(float dt) {
+    if (contact_events_ != nullptr) {
+      contact_events_->Begin();
+    }
+    EPhysicsUpdateError error = Advance(dt);
+    if (contact_events_ != nullptr) {
+      contact_events_->End();
+    }
+    if (activation_tracker_ != nullptr) {
+      activation_tracker_->Publish();
+    }
+    if (sensor_tracker_ != nullptr) {
+      sensor_tracker_->Publish();
+    }
+    return error;
+  }
+
+  ActivationEvents *EnableActivationEvents() {
+    if (activation_tracker_ == nullptr) {
+      activation_tracker_ = std::make_unique<ActivationTracker>(physics_system_->GetMaxBodies());
+      BodyIDVector active;
+      physics_system_->GetActiveBodies(EBodyType::RigidBody, active);
+      activation_tracker_->Seed(active);
+      physics_system_->SetBodyActivationListener(activation_tracker_.get());
+    }
+    return activation_tracker_->events();
+  }
+
+  ContactEventBuffer *EnableContactEvents(int capacity) {
+    if (contact_events_ == nullptr) {
+      contact_events_ = std::make_unique<ContactEventRecorder>(capacity, &contact_event_opt_in_);
+      AddContactListener(contact_events_.get());
+    }
+    return contact_events_->buffer();
+  }
+
+  SensorEvents *EnableSensorEvents() {
+    if (sensor_tracker_ == nullptr) {
+      sensor_tracker_ = std::make_unique<SensorTracker>();
+      AddContactListener(sensor_tracker_.get());
+    }
+    return sensor_tracker_->events();
+  }
+
+  void SetContactEventsEnabled(const BodyID &id, bool enabled) {
+    if (id.GetIndex() >= contact_event_opt_in_.size()) {
+      contact_event_opt_in_.resize(id.GetIndex() + 1, 0);
+    }
+    contact_event_opt_in_[id.GetIndex()] = enabled ? 1 : 0;
+  }
+
+  EPhysicsUpdateError Advance(float dt) {
+    const float fixed_dt = step_config_.fixed_dt;
+    if (fixed_dt <= 0.0f) {
+      return Update(dt);
+    }
+    EPhysicsUpdateError error = EPhysicsUpdateError::None;
+    accumulator_ += dt;
+    int substeps = 0;
+    while (accumulator_ >= fixed_dt && substeps < step_config_.max_substeps) {
+      error |= Update(fixed_dt);
+      accumulator_ -= fixed_dt;
+      substeps++;
+    }
+    if (accumulator_ >= fixed_dt) {
+      // We fell behind. Drop the whole steps we couldn't afford instead of
+      // trying to catch up next frame.
+      accumulator_ = std::fmod(accumulator_, fixed_dt);
+    }
+    return error;
+  }
+
+  // Runs Step(dt) on the world's step thread and posts the resulting error
+  // code to port when done. Returns false if a step is already in flight.
+  bool StepAsync(float dt, Dart_Port_DL port) {
+    std::lock_guard<std::mutex> lock(step_mutex_);
+    if (step_in_flight_) {
+      return false;
+    }
+    if (!step_thread_.joinable()) {
+      step_thread_ = std::thread([this]() { StepThreadMain(); });
+    }
+    step_dt_ = dt;
+    step_port_ = port;
+    step_in_flight_ = true;
+    step_cv_.notify_all();
+    return true;
+  }
+
+  // Blocks until the in flight async step, if any, is done and returns its
+  // error code.
+  int WaitForStep() {
+    std::unique_lock<std::mutex> lock(step_mutex_);
+    step_cv_.wait(lock, [this]() { return !step_in_flight_; });
+    return step_result_;
+  }
+
+  bool IsStepping() {
+    std::lock_guard<std::mutex> lock(step_mutex_);
+    return step_in_flight_;
+  }
+
+  // Scratch storage reused by world_get_active_transforms. Separate from the
+  // list the mirror update fills on the step thread.
+  BodyIDVector &active_bodies() { return queried_active_bodies_; }
+
+  // Assigns a mirror slot to a body that is being added to the world. Slots
+  // are stable for as long as the body stays in the world.
+  int AcquireMirrorSlot(const BodyID &id) {
+    int slot;
+    if (!free_mirror_slots_.empty()) {
+      slot = free_mirror_slots_.back();
+      free_mirror_slots_.pop_back();
+    } else {
+      slot = num_mirror_slots_++;
+    }
+    if (id.GetIndex() >= mirror_slot_by_index_.size()) {
+      mirror_slot_by_index_.resize(id.GetIndex() + 1, -1);
+    }
+    mirror_slot_by_index_[id.GetIndex()] = slot;
+    MirrorBody(id);
+    return slot;
+  }
+
+  void ReleaseMirrorSlot(const BodyID &id) {
+    int slot = GetMirrorSlot(id);
+    if (slot < 0) {
+      return;
+    }
+    mirror_slot_by_index_[id.GetIndex()] = -1;
+    free_mirror_slots_.push_back(slot);
+  }
+
+  int GetMirrorSlot(const BodyID &id) const {
+    if (id.GetIndex() >= mirror_slot_by_index_.size()) {
+      return -1;
+    }
+    return mirror_slot_by_index_[id.GetIndex()];
+  }
+
+  TransformMirror *EnableTransformMirror(int capacity, bool matrices) {
+    if (mirror_ == nullptr) {
+      mirror_ = std::make_unique<TransformMirrorStorage>(capacity, matrices);
+      // Seed the mirror with bodies that were added before it existed.
+      BodyIDVector bodies;
+      physics_system_->GetBodies(bodies);
+      for (const BodyID &id : bodies) {
+        MirrorBody(id);
+      }
+    }
+    return mirror_->mirror();
+  }
+
+  // Writes the current transform of a body into the mirror. Used for bodies
+  // that are moved outside of a step.
+  void MirrorBody(const BodyID &id) {
+    if (mirror_ == nullptr) {
+      return;
+    }
+    MirrorBody(physics_system_->GetBodyLockInterfaceNoLock().TryGetBody(id));
+  }
+
+  // Called before PhysicsSystem::Update with the bodies that may move.
+  void BeginMirrorUpdate() {
+    if (mirror_ == nullptr) {
+      return;
+    }
+    physics_system_->GetActiveBodies(EBodyType::RigidBody, active_bodies_);
+  }
+
+  // Called after PhysicsSystem::Update. Fills the next buffer with everything
+  // that was active before or after the step and then publishes it.
+  void EndMirrorUpdate() {
+    if (mirror_ == nullptr) {
+      return;
+    }
+    mirror_->CopyCurrentToNext(num_mirror_slots_);
+    WriteMirror(mirror_->next(), active_bodies_);
+    physics_system_->GetActiveBodies(EBodyType::RigidBody, active_bodies_);
+    WriteMirror(mirror_->next(), active_bodies_);
+    mirror_->Swap();
+  }
 
 private:
   std::unique_ptr<TempAllocator> temp_allocator_;
-  std::unique_ptr<JobSystem> job_system_;
+  // Null when the world uses the shared pool.
+  std::unique_ptr<JobSystem> owned_job_system_;
+  JobSystem *job_system_;
   std::unique_ptr<BroadPhaseLayerInterfaceMask> bp_layer_interface_;
   std::unique_ptr<ObjectVsBroadPhaseLayerFilterMask>
       object_vs_broad_phase_layer_filter_;
   std::unique_ptr<ObjectLayerPairFilterMask>
       object_vs_object_layer_pair_filter_;
   std::unique_ptr<PhysicsSystem> physics_system_;
+  BodyIDVector active_bodies_;
+  BodyIDVector queried_active_bodies_;
+  StepConfig step_config_ = {0.0f, 1, 1};
+  float accumulator_ = 0.0f;
+
+  std::unique_ptr<ContactEventRecorder> contact_events_;
+  std::unique_ptr<ActivationTracker> activation_tracker_;
+  std::unique_ptr<SensorTracker> sensor_tracker_;
+  ContactListenerList contact_listeners_;
+
+  void AddContactListener(ContactListener *listener) {
+    contact_listeners_.Add(listener);
+    physics_system_->SetContactListener(&contact_listeners_);
+  }
+  // Non zero for bodies that want contact events, indexed by body index.
+  std::vector<uint8_t> contact_event_opt_in_;
+
+  void StepThreadMain() {
+    std::unique_lock<std::mutex> lock(step_mutex_);
+    while (true) {
+      step_cv_.wait(lock, [this]() { return step_thread_exit_ || (step_in_flight_ && !step_running_); });
+      if (step_thread_exit_) {
+        return;
+      }
+      step_running_ = true;
+      float dt = step_dt_;
+      Dart_Port_DL port = step_port_;
+      lock.unlock();
+      int result = static_cast<int>(Step(dt));
+      lock.lock();
+      step_result_ = result;
+      step_running_ = false;
+      step_in_flight_ = false;
+      step_cv_.notify_all();
+      if (port != ILLEGAL_PORT) {
+        Dart_PostInteger_DL(port, result);
+      }
+    }
+  }
+
+  // Dedicated thread for world_step_async, started on first use.
+  std::thread step_thread_;
+  std::mutex step_mutex_;
+  std::condition_variable step_cv_;
+  bool step_in_flight_ = false;
+  bool step_running_ = false;
+  bool step_thread_exit_ = false;
+  float step_dt_ = 0.0f;
+  Dart_Port_DL step_port_ = ILLEGAL_PORT;
+  int step_result_ = 0;
+
+  void MirrorBody(const Body *body) {
+    if (body == nullptr) {
+      return;
+    }
+    int slot = GetMirrorSlot(body->GetID());
+    if (mirror_->HasSlot(slot)) {
+      // Write every buffer so a body that was moved directly does not get
+      // interpolated from its old transform.
+      for (int i = 0; i < kMirrorBuffers; i++) {
+        mirror_->Write(i, slot, *body);
+      }
+    }
+  }
 
-  // This is the max amount of rigid bodies that you can add to the physics
-  // system. If you try to add more you'll get an error. Note: This value is low
-  // because this is a simple test. For a real project use something in the
-  // order of 65536.
-  static const int cMaxBodies = 65536;
-
-  // This determines how many mutexes to allocate to protect rigid bodies from
-  // concurrent access. Set it to 0 for the default settings.
-  static const int cNumBodyMutexes = 0;
-
-  // This is the max amount of body pairs that can be queued at any time (the
-  // broad phase will detect overlapping body pairs based on their bounding
-  // boxes and will insert them into a queue for the narrowphase). If you make
-  // this buffer too small the queue will fill up and the broad phase jobs will
-  // start to do narrow phase work. This is slightly less efficient. Note: This
-  // value is low because this is a simple test. For a real project use
-  // something in the order of 65536.
-  static const uint cMaxBodyPairs = 65536;
-
-  // This is the maximum size of the contact constraint buffer. If more contacts
-  // (collisions between bodies) are detected than this number then these
-  // contacts will be ignored and bodies will start interpenetrating / fall
-  // through the world. Note: This value is low because this is a simple test.
-  // For a real project use something in the order of 10240.
-  static const uint cMaxContactConstraints = 10240;
+  void WriteMirror(int buffer, const BodyIDVector &ids) {
+    const BodyLockInterfaceNoLock &lock_interface = physics_system_->GetBodyLockInterfaceNoLock();
+    for (const BodyID &id : ids) {
+      int slot = GetMirrorSlot(id);
+      if (!mirror_->HasSlot(slot)) {
+        continue;
+      }
+      const Body *body = lock_interface.TryGetBody(id);
+      if (body != nullptr) {
+        mirror_->Write(buffer, slot, *body);
+      }
+    }
+  }
+
+  std::unique_ptr<TransformMirrorStorage> mirror_;
+  // Mirror slot for each body in the world indexed by body index, -1 if none.
+  std::vector<int> mirror_slot_by_index_;
+  std::vector<int> free_mirror_slots_;
+  int num_mirror_slots_ = 0;
 };
 
+class ShapeCache;
+
+// Shapes are reference counted so that equal shapes can be shared between
+// callers, see ShapeCache. Every create_*_shape call hands out one reference
+// which is dropped by destroy_shape.
 class CollisionShape {
 public:
   explicit CollisionShape(Ref<Shape> shape) : shape_(shape) {
   }
 
-  ~CollisionShape() {
-    if (shape_ != nullptr) {
-      Dart_DeleteWeakPersistentHandle_DL(reinterpret_cast<Dart_WeakPersistentHandle>(shape_->GetUserData()));
-    }
-  }
+  ~CollisionShape();
 
   static void SetDartOwner(CollisionShape *shape, Dart_Handle owner) {
+    // Interned shapes can outlive their first Dart owner.
+    if (shape->shape_->GetUserData() != 0) {
+      Dart_DeleteWeakPersistentHandle_DL(reinterpret_cast<Dart_WeakPersistentHandle>(shape->shape_->GetUserData()));
+    }
     shape->shape_->SetUserData(reinterpret_cast<int64_t>(
         Dart_NewWeakPersistentHandle_DL(owner, nullptr, 0, NoopFinalizer)));
   }
@@ -181,10 +975,190 @@ public:
 
   Shape *shape() { return shape_; }
 
+  // Takes a reference to the shape this one decorates.
+  void SetInner(CollisionShape *inner);
+
 private:
+  friend class ShapeCache;
+
   Ref<Shape> shape_;
+  // Guarded by the ShapeCache mutex.
+  int refs_ = 1;
+  // Key in the ShapeCache, empty if the shape isn't interned.
+  std::string cache_key_;
+  // Shape this one decorates. Holding a reference keeps the inner shape's
+  // address, which is part of our cache key, from being reused.
+  CollisionShape *inner_ = nullptr;
+};
+
+// Process wide table of interned shapes keyed by their creation parameters.
+// The table doesn't keep shapes alive, a shape is removed when its last
+// reference is released.
+class ShapeCache {
+public:
+  static ShapeCache &Get() {
+    static ShapeCache cache;
+    return cache;
+  }
+
+  // Returns a new reference to the shape interned under key, or null. Keys
+  // only hold a hash of large inputs, content is the hashed bytes and must
+  // match too, so a hash collision is a miss rather than another shape.
+  CollisionShape *Find(const std::string &key, const std::string &content) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = shapes_.find(key);
+    if (it == shapes_.end() || it->second.content != content) {
+      stats_.misses++;
+      return nullptr;
+    }
+    stats_.hits++;
+    it->second.shape->refs_++;
+    return it->second.shape;
+  }
+
+  // Interns a shape that was created after Find missed. If another thread
+  // interned an equal shape in the meantime that one is returned instead. A
+  // shape whose key collides with a different one stays uninterned.
+  CollisionShape *Insert(const std::string &key, const std::string &content, CollisionShape *shape) {
+    if (shape == nullptr) {
+      return nullptr;
+    }
+    CollisionShape *existing = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = shapes_.find(key);
+      if (it == shapes_.end()) {
+        shape->cache_key_ = key;
+        shapes_.emplace(key, Entry{shape, content});
+        return shape;
+      }
+      if (it->second.content != content) {
+        return shape;
+      }
+      existing = it->second.shape;
+      existing->refs_++;
+    }
+    delete shape;
+    return existing;
+  }
+
+  void Retain(CollisionShape *shape) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shape->refs_++;
+  }
+
+  void Release(CollisionShape *shape) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--shape->refs_ > 0) {
+        return;
+      }
+      if (!shape->cache_key_.empty()) {
+        shapes_.erase(shape->cache_key_);
+      }
+    }
+    // Outside the lock, deleting a decorated shape releases its inner shape.
+    delete shape;
+  }
+
+  void GetStats(ShapeCacheStats *stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *stats = stats_;
+    stats->num_shapes = static_cast<int>(shapes_.size());
+  }
+
+private:
+  struct Entry {
+    CollisionShape *shape;
+    std::string content;
+  };
+
+  std::mutex mutex_;
+  std::unordered_map<std::string, Entry> shapes_;
+  ShapeCacheStats stats_ = {};
+};
+
+void CollisionShape::SetInner(CollisionShape *inner) {
+  ShapeCache::Get().Retain(inner);
+  inner_ = inner;
+}
+
+CollisionShape::~CollisionShape() {
+  if (shape_ != nullptr && shape_->GetUserData() != 0) {
+    Dart_DeleteWeakPersistentHandle_DL(reinterpret_cast<Dart_WeakPersistentHandle>(shape_->GetUserData()));
+  }
+  if (inner_ != nullptr) {
+    ShapeCache::Get().Release(inner_);
+  }
+}
+
+// Incremental 64 bit FNV-1a hash. Hashing a buffer in pieces gives the same
+// value as hashing it at once. Also keeps the hashed bytes, FNV collisions are
+// easy to build so the cache compares them on a hit.
+class ContentHash {
+public:
+  void Update(const void *data, size_t size) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash_ = (hash_ ^ bytes[i]) * 1099511628211ull;
+    }
+    bytes_.append(reinterpret_cast<const char *>(bytes), size);
+  }
+
+  uint64_t value() const { return hash_; }
+
+  uint64_t size() const { return bytes_.size(); }
+
+  const std::string &bytes() const { return bytes_; }
+
+private:
+  uint64_t hash_ = 14695981039346656037ull;
+  std::string bytes_;
+};
+
+// Builds ShapeCache keys from the raw bytes of shape parameters.
+class ShapeKey {
+public:
+  explicit ShapeKey(char kind) { key_.push_back(kind); }
+
+  template <typename T>
+  ShapeKey &Add(const T &value) {
+    key_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    return *this;
+  }
+
+  // Adds a 64 bit FNV-1a hash of data instead of the data itself, for point
+  // clouds and meshes. The data goes to content() for the cache to compare.
+  ShapeKey &AddContentHash(const void *data, size_t size) {
+    ContentHash hash;
+    hash.Update(data, size);
+    return AddContentHash(hash);
+  }
+
+  ShapeKey &AddContentHash(const ContentHash &hash) {
+    content_.append(hash.bytes());
+    return Add(hash.size()).Add(hash.value());
+  }
+
+  const std::string &str() const { return key_; }
+
+  const std::string &content() const { return content_; }
+
+private:
+  std::string key_;
+  std::string content_;
 };
 
+// Returns the shape interned under key, calling create to make it on a miss.
+template <typename CreateFn>
+static CollisionShape *InternShape(const ShapeKey &key, CreateFn create) {
+  ShapeCache &cache = ShapeCache::Get();
+  if (CollisionShape *shape = cache.Find(key.str(), key.content())) {
+    return shape;
+  }
+  return cache.Insert(key.str(), key.content(), create());
+}
+
 class WorldBody {
 public:
   WorldBody(World *world, Body *body) : world_(world), body_(body) {
@@ -216,11 +1190,13 @@ public:
   void SetPosition(float *v4) {
     interface().SetPosition(id(), *reinterpret_cast<Vec3 *>(v4),
                             EActivation::DontActivate);
+    world_->MirrorBody(id());
   }
 
   void SetRotation(float *q4) {
     interface().SetRotation(id(), *reinterpret_cast<Quat *>(q4),
                             EActivation::DontActivate);
+    world_->MirrorBody(id());
   }
 
   void GetPosition(float *v4) {
@@ -247,18 +1223,111 @@ private:
   Dart_WeakPersistentHandle owner_ = nullptr;
 };
 
-FFI_PLUGIN_EXPORT World *create_world() {
+FFI_PLUGIN_EXPORT void world_config_init_defaults(WorldConfig* config) {
+  config->max_bodies = 65536;
+  config->num_body_mutexes = 0;
+  config->max_body_pairs = 65536;
+  config->max_contact_constraints = 10240;
+  config->temp_allocator_size = 10 * 1024 * 1024;
+  config->num_threads = -1;
+  config->gravity[0] = 0.0f;
+  config->gravity[1] = -9.81f;
+  config->gravity[2] = 0.0f;
+  config->num_broad_phase_layers = 2;
+}
+
+FFI_PLUGIN_EXPORT World *create_world(WorldConfig* config) {
   init_jph_once();
-  return new World();
+  if (config == nullptr) {
+    WorldConfig defaults;
+    world_config_init_defaults(&defaults);
+    return new World(defaults);
+  }
+  return new World(*config);
 }
 
 FFI_PLUGIN_EXPORT int world_step(World *world, float dt) {
-  // TODO(johnmccutchan): Collision steps needs to be configurable.
-  EPhysicsUpdateError error = world->physics_system().Update(
-      dt, 1, world->temp_allocator(), world->job_system());
+  // Never overlap with an async step.
+  world->WaitForStep();
+  EPhysicsUpdateError error = world->Step(dt);
   return (int)error;
 }
 
+FFI_PLUGIN_EXPORT void world_set_step_config(World* world, StepConfig* config) {
+  world->SetStepConfig(*config);
+}
+
+FFI_PLUGIN_EXPORT float world_get_interpolation_alpha(World* world) {
+  return world->interpolation_alpha();
+}
+
+FFI_PLUGIN_EXPORT bool world_step_async(World* world, float dt, Dart_Port_DL port) {
+  return world->StepAsync(dt, port);
+}
+
+FFI_PLUGIN_EXPORT int world_step_wait(World* world) {
+  return world->WaitForStep();
+}
+
+FFI_PLUGIN_EXPORT bool world_step_poll(World* world) {
+  return !world->IsStepping();
+}
+
+FFI_PLUGIN_EXPORT ContactEventBuffer* world_enable_contact_events(World* world, int capacity) {
+  return world->EnableContactEvents(capacity);
+}
+
+FFI_PLUGIN_EXPORT ActivationEvents* world_enable_activation_events(World* world) {
+  return world->EnableActivationEvents();
+}
+
+FFI_PLUGIN_EXPORT SensorEvents* world_enable_sensor_events(World* world) {
+  return world->EnableSensorEvents();
+}
+
+FFI_PLUGIN_EXPORT int world_get_active_transforms(World* world, BodyTransform* out, int max_transforms) {
+  PhysicsSystem& physics_system = world->physics_system();
+  BodyIDVector& active = world->active_bodies();
+  physics_system.GetActiveBodies(EBodyType::RigidBody, active);
+  if (static_cast<int>(active.size()) > max_transforms) {
+    // Let the caller grow its buffer and try again.
+    return static_cast<int>(active.size());
+  }
+  // Not called during a step so we can skip taking the body locks.
+  const BodyLockInterfaceNoLock& lock_interface = physics_system.GetBodyLockInterfaceNoLock();
+  int count = 0;
+  for (const BodyID& id : active) {
+    const Body* body = lock_interface.TryGetBody(id);
+    if (body == nullptr) {
+      continue;
+    }
+    BodyTransform& transform = out[count++];
+    transform.body_index = id.GetIndex();
+    // m16 is not 16 byte aligned so it can't be written as a Mat44.
+    body->GetWorldTransform().StoreFloat4x4(reinterpret_cast<Float4*>(transform.m16));
+  }
+  return count;
+}
+
+// Computes the world space surface normal at a ray hit. Returns false if the
+// body has been deleted out from under us. With no_lock the caller guarantees
+// that no step is running so the body mutexes can be skipped.
+static bool GetRayHitNormal(World* world, const RRayCast& ray, const RayCastResult& hit, bool no_lock, float* n3) {
+  PhysicsSystem& physics_system = world->physics_system();
+  const BodyLockInterface& lock_interface = no_lock
+      ? static_cast<const BodyLockInterface&>(physics_system.GetBodyLockInterfaceNoLock())
+      : static_cast<const BodyLockInterface&>(physics_system.GetBodyLockInterface());
+  BodyLockRead lock(lock_interface, hit.mBodyID);
+  if (!lock.Succeeded()) {
+    return false;
+  }
+  Vec3 n = lock.GetBody().GetWorldSpaceSurfaceNormal(hit.mSubShapeID2, ray.GetPointOnRay(hit.mFraction));
+  n3[0] = n.GetX();
+  n3[1] = n.GetY();
+  n3[2] = n.GetZ();
+  return true;
+}
+
 FFI_PLUGIN_EXPORT void world_raycast(World* world,
                                      RayCastConfig* config) {
   const NarrowPhaseQuery& query = world->physics_system().GetNarrowPhaseQuery();
@@ -268,6 +1337,29 @@ FFI_PLUGIN_EXPORT void world_raycast(World* world,
   float* e3 = &config->end[0];
   in_ray.mOrigin.Set(s3[0], s3[1], s3[2]);
   in_ray.mDirection.Set(e3[0] - s3[0], e3[1] - s3[1], e3[2] - s3[2]);
+  RayCastSettings settings;
+
+  if (config->flags & kRayCastNoLock) {
+    // Collect all hits without leaving the query, then resolve normals and
+    // report hits in order of distance. Because hits are sorted, filtering on
+    // the returned fraction gives the same result as an early out.
+    AllHitCollisionCollector<CastRayCollector> collector;
+    query.CastRay(in_ray, settings, collector);
+    collector.Sort();
+    float early_out_fraction = FLT_MAX;
+    for (const RayCastResult& hit : collector.mHits) {
+      if (hit.mFraction >= early_out_fraction) {
+        continue;
+      }
+      float n[3] = { 0.0f, 0.0f, 0.0f };
+      if (!GetRayHitNormal(world, in_ray, hit, true, n)) {
+        continue;
+      }
+      Dart_Handle owner = world->GetDartOwnerForBody(hit.mBodyID);
+      early_out_fraction = config->cb(owner, hit.mFraction, n);
+    }
+    return;
+  }
 
   class Collector : public CastRayCollector {
     public:
@@ -276,16 +1368,9 @@ FFI_PLUGIN_EXPORT void world_raycast(World* world,
     void AddHit(const RayCastResult &inResult) override {
       const auto& id = inResult.mBodyID;
       float n[3] = { 0.0f, 0.0f, 0.0f };
-      {
-        // Populate normal.
-        const BodyLockInterfaceLocking& lock_interface	= world_->physics_system().GetBodyLockInterface();
-        BodyLockRead lock(lock_interface, id);
-        if (!lock.Succeeded()) {
-          // Body has been deleted out from under us.
-          return;
-        }
-        const Body& body = lock.GetBody();
-        *reinterpret_cast<Vec3*>(&n[0]) = body.GetWorldSpaceSurfaceNormal(inResult.mSubShapeID2, in_ray_.GetPointOnRay(inResult.mFraction));
+      if (!GetRayHitNormal(world_, in_ray_, inResult, false, n)) {
+        // Body has been deleted out from under us.
+        return;
       }
 
       Dart_Handle owner = world_->GetDartOwnerForBody(id);
@@ -298,27 +1383,137 @@ FFI_PLUGIN_EXPORT void world_raycast(World* world,
       ResetEarlyOutFraction(early_out_fraction);
     }
 
-    private:
-    World* world_;
-    RayCastConfig* config_;
-    const RRayCast& in_ray_;
-  };
-    
-  Collector collector(world, config, in_ray);
-  RayCastSettings settings;
-  query.CastRay(in_ray, settings, collector);
+    private:
+    World* world_;
+    RayCastConfig* config_;
+    const RRayCast& in_ray_;
+  };
+    
+  Collector collector(world, config, in_ray);
+  query.CastRay(in_ray, settings, collector);
+}
+
+static void CastRayForBatch(World* world, const Ray& ray, int mode, int flags, RayCastHit* out) {
+  const NarrowPhaseQuery& query = world->physics_system().GetNarrowPhaseQuery();
+  RRayCast in_ray;
+  in_ray.mOrigin.Set(ray.start[0], ray.start[1], ray.start[2]);
+  in_ray.mDirection.Set(ray.end[0] - ray.start[0], ray.end[1] - ray.start[1], ray.end[2] - ray.start[2]);
+
+  RayCastResult hit;
+  bool had_hit = false;
+  if (mode == kRayCastAny) {
+    AnyHitCollisionCollector<CastRayCollector> collector;
+    query.CastRay(in_ray, RayCastSettings(), collector);
+    had_hit = collector.HadHit();
+    if (had_hit) {
+      hit = collector.mHit;
+    }
+  } else {
+    had_hit = query.CastRay(in_ray, hit);
+  }
+
+  out->body_index = -1;
+  out->sub_shape_id = 0;
+  out->fraction = 1.0f;
+  out->normal[0] = out->normal[1] = out->normal[2] = 0.0f;
+  if (!had_hit) {
+    return;
+  }
+  if (!GetRayHitNormal(world, in_ray, hit, (flags & kRayCastNoLock) != 0, out->normal)) {
+    // Body has been deleted out from under us.
+    return;
+  }
+  out->body_index = static_cast<int32_t>(hit.mBodyID.GetIndex());
+  out->sub_shape_id = hit.mSubShapeID2.GetValue();
+  out->fraction = hit.mFraction;
+}
+
+FFI_PLUGIN_EXPORT void world_raycast_batch(World* world, const Ray* rays, int num_rays, RayCastHit* out, int mode) {
+  if (num_rays <= 0) {
+    return;
+  }
+  const int flags = mode & kRayCastNoLock;
+  mode &= ~kRayCastNoLock;
+  // Keep the number of jobs well below cMaxPhysicsJobs.
+  const int rays_per_job = std::max(64, (num_rays + 1023) / 1024);
+  JobSystem* job_system = world->job_system();
+  JobSystem::Barrier* barrier = job_system->CreateBarrier();
+  for (int start = 0; start < num_rays; start += rays_per_job) {
+    int end = std::min(start + rays_per_job, num_rays);
+    JobHandle job = job_system->CreateJob("RayCastBatch", Color::sGreen, [=]() {
+      for (int i = start; i < end; i++) {
+        CastRayForBatch(world, rays[i], mode, flags, &out[i]);
+      }
+    });
+    barrier->AddJob(job);
+  }
+  job_system->WaitForJobs(barrier);
+  job_system->DestroyBarrier(barrier);
+}
+
+FFI_PLUGIN_EXPORT void destroy_world(World *world) {
+  delete world;
+}
+
+FFI_PLUGIN_EXPORT void world_add_body(World* world, WorldBody* body, int activation) {
+  world->body_interface().AddBody(body->id(),  static_cast<EActivation>(activation));
+  world->AcquireMirrorSlot(body->id());
+}
+
+FFI_PLUGIN_EXPORT void world_remove_body(World* world, WorldBody* body) {
+  world->ReleaseMirrorSlot(body->id());
+  world->body_interface().RemoveBody(body->id());
+}
+
+// Bodies that are part of a batched add.
+class BodyBatch {
+public:
+  BodyBatch(WorldBody **bodies, int num_bodies) {
+    ids_.reserve(num_bodies);
+    for (int i = 0; i < num_bodies; i++) {
+      ids_.push_back(bodies[i]->id());
+    }
+  }
+
+  // AddBodiesPrepare may reorder the ids.
+  BodyID *ids() { return ids_.data(); }
+
+  int size() const { return static_cast<int>(ids_.size()); }
+
+  BodyInterface::AddState state = nullptr;
+
+private:
+  BodyIDVector ids_;
+};
+
+FFI_PLUGIN_EXPORT BodyBatch* world_add_bodies_prepare(World* world, WorldBody** bodies, int num_bodies) {
+  BodyBatch* batch = new BodyBatch(bodies, num_bodies);
+  batch->state = world->body_interface().AddBodiesPrepare(batch->ids(), batch->size());
+  return batch;
 }
 
-FFI_PLUGIN_EXPORT void destroy_world(World *world) {
-  delete world;
+FFI_PLUGIN_EXPORT void world_add_bodies_finalize(World* world, BodyBatch* batch, int activation) {
+  world->body_interface().AddBodiesFinalize(batch->ids(), batch->size(), batch->state, static_cast<EActivation>(activation));
+  for (int i = 0; i < batch->size(); i++) {
+    world->AcquireMirrorSlot(batch->ids()[i]);
+  }
+  delete batch;
 }
 
-FFI_PLUGIN_EXPORT void world_add_body(World* world, WorldBody* body, int activation) {
-  world->body_interface().AddBody(body->id(),  static_cast<EActivation>(activation));
+FFI_PLUGIN_EXPORT void world_add_bodies_abort(World* world, BodyBatch* batch) {
+  world->body_interface().AddBodiesAbort(batch->ids(), batch->size(), batch->state);
+  delete batch;
 }
 
-FFI_PLUGIN_EXPORT void world_remove_body(World* world, WorldBody* body) {
-  world->body_interface().RemoveBody(body->id());
+FFI_PLUGIN_EXPORT void world_add_bodies(World* world, WorldBody** bodies, int num_bodies, int activation) {
+  if (num_bodies == 0) {
+    return;
+  }
+  world_add_bodies_finalize(world, world_add_bodies_prepare(world, bodies, num_bodies), activation);
+}
+
+FFI_PLUGIN_EXPORT TransformMirror* world_enable_transform_mirror(World* world, int capacity, bool matrices) {
+  return world->EnableTransformMirror(capacity, matrices);
 }
 
 void assert_shape_result(const char* kind, const JPH::ShapeSettings::ShapeResult& result) {
@@ -329,7 +1524,7 @@ void assert_shape_result(const char* kind, const JPH::ShapeSettings::ShapeResult
   assert(!result.HasError());
 }
 
-FFI_PLUGIN_EXPORT CollisionShape* create_decorated_shape(DecoratedShapeConfig* config) {
+static CollisionShape* CreateDecoratedShape(DecoratedShapeConfig* config) {
  switch (config->type) {
   case kScaled: {
     ScaledShapeSettings settings;
@@ -364,21 +1559,159 @@ FFI_PLUGIN_EXPORT CollisionShape* create_decorated_shape(DecoratedShapeConfig* c
  }
 }
 
-FFI_PLUGIN_EXPORT CollisionShape* create_mesh_shape(float* vertices, int num_vertices, uint32_t* triangles, int num_triangles) {
-  MeshShapeSettings settings;
-  settings.mTriangleVertices.reserve(num_vertices);
-  for (int i = 0; i < num_vertices; i++) {
-    settings.mTriangleVertices.push_back(Float3(vertices[i * 3 + 0], vertices[i * 3 + 1], vertices[i * 3 + 2]));
+FFI_PLUGIN_EXPORT CollisionShape* create_decorated_shape(DecoratedShapeConfig* config) {
+  ShapeKey key('D');
+  key.Add(config->type).Add(config->inner_shape).Add(config->v3).Add(config->q4);
+  return InternShape(key, [config]() {
+    CollisionShape* shape = CreateDecoratedShape(config);
+    if (shape != nullptr) {
+      shape->SetInner(config->inner_shape);
+    }
+    return shape;
+  });
+}
+
+// Reads positions and triangle indices straight out of caller buffers laid
+// out as described by a MeshInput, such as interleaved render buffers.
+class MeshReader {
+public:
+  explicit MeshReader(const MeshInput &input)
+      : input_(input),
+        vertices_(static_cast<const uint8_t *>(input.vertices) + input.position_offset),
+        stride_(input.vertex_stride > 0 ? input.vertex_stride : sizeof(Float3)) {}
+
+  int num_vertices() const { return input_.num_vertices; }
+
+  int num_triangles() const { return input_.indices != nullptr ? input_.num_triangles : 0; }
+
+  // Hashes the positions as if they were tightly packed so that equal meshes
+  // get equal keys whatever their layout.
+  void HashVertices(ContentHash &hash) const {
+    if (IsPacked()) {
+      hash.Update(vertices_, sizeof(Float3) * num_vertices());
+      return;
+    }
+    for (int i = 0; i < num_vertices(); i++) {
+      hash.Update(vertices_ + stride_ * i, sizeof(Float3));
+    }
+  }
+
+  // Hashes the indices as if they were 32 bit.
+  void HashIndices(ContentHash &hash) const {
+    if (input_.index_type == kMeshIndexU32) {
+      hash.Update(input_.indices, sizeof(uint32_t) * 3 * num_triangles());
+      return;
+    }
+    for (int i = 0; i < 3 * num_triangles(); i++) {
+      uint32_t index = Index(i);
+      hash.Update(&index, sizeof(index));
+    }
+  }
+
+  void ReadVertices(VertexList &out) const {
+    out.resize(num_vertices());
+    if (IsPacked()) {
+      memcpy(out.data(), vertices_, sizeof(Float3) * num_vertices());
+      return;
+    }
+    for (int i = 0; i < num_vertices(); i++) {
+      memcpy(&out[i], vertices_ + stride_ * i, sizeof(Float3));
+    }
+  }
+
+  void ReadPoints(Array<Vec3> &out) const {
+    out.resize(num_vertices());
+    for (int i = 0; i < num_vertices(); i++) {
+      Float3 position;
+      memcpy(&position, vertices_ + stride_ * i, sizeof(Float3));
+      out[i] = Vec3(position);
+    }
+  }
+
+  // Reads the indices as 32 bit, packed i0, i1, i2.
+  void ReadIndices(Array<uint32_t> &out) const {
+    out.resize(3 * num_triangles());
+    if (input_.index_type == kMeshIndexU32) {
+      memcpy(out.data(), input_.indices, sizeof(uint32_t) * out.size());
+      return;
+    }
+    for (size_t i = 0; i < out.size(); i++) {
+      out[i] = Index(i);
+    }
+  }
+
+  void ReadTriangles(IndexedTriangleList &out) const {
+    out.resize(num_triangles());
+    for (int i = 0; i < num_triangles(); i++) {
+      out[i] = IndexedTriangle(Index(i * 3 + 0), Index(i * 3 + 1), Index(i * 3 + 2));
+    }
   }
-  settings.mIndexedTriangles.reserve(num_triangles);
-  for (int i = 0; i < num_triangles; i++) {
-    settings.mIndexedTriangles.push_back(IndexedTriangle(triangles[i * 3 + 0], triangles[i * 3 + 1], triangles[i * 3 + 2]));
+
+private:
+  bool IsPacked() const { return stride_ == sizeof(Float3); }
+
+  uint32_t Index(int i) const {
+    if (input_.index_type == kMeshIndexU16) {
+      return static_cast<const uint16_t *>(input_.indices)[i];
+    }
+    return static_cast<const uint32_t *>(input_.indices)[i];
   }
+
+  const MeshInput &input_;
+  const uint8_t *vertices_;
+  size_t stride_;
+};
+
+static MeshInput PackedMeshInput(const float* vertices, int num_vertices, const uint32_t* triangles, int num_triangles) {
+  MeshInput input = {};
+  input.vertices = vertices;
+  input.num_vertices = num_vertices;
+  input.indices = triangles;
+  input.num_triangles = num_triangles;
+  input.index_type = kMeshIndexU32;
+  return input;
+}
+
+static CollisionShape* CreateMeshShape(const MeshReader& reader) {
+  MeshShapeSettings settings;
+  reader.ReadVertices(settings.mTriangleVertices);
+  reader.ReadTriangles(settings.mIndexedTriangles);
   auto result = settings.Create();
   assert_shape_result("mesh", result);
   return new CollisionShape(result.Get());
 }
 
+FFI_PLUGIN_EXPORT CollisionShape* create_mesh_shape_strided(const MeshInput* input) {
+  MeshReader reader(*input);
+  ContentHash vertices;
+  reader.HashVertices(vertices);
+  ContentHash triangles;
+  reader.HashIndices(triangles);
+  ShapeKey key('M');
+  key.AddContentHash(vertices).AddContentHash(triangles);
+  return InternShape(key, [&reader]() {
+    return CreateMeshShape(reader);
+  });
+}
+
+FFI_PLUGIN_EXPORT CollisionShape* create_mesh_shape(float* vertices, int num_vertices, uint32_t* triangles, int num_triangles) {
+  MeshInput input = PackedMeshInput(vertices, num_vertices, triangles, num_triangles);
+  return create_mesh_shape_strided(&input);
+}
+
+FFI_PLUGIN_EXPORT CollisionShape* create_mesh_shape_strided_flat(const uint8_t* vertices, int num_vertices, int vertex_stride, int position_offset,
+                                                                 const uint8_t* indices, int num_triangles, int index_type) {
+  MeshInput input = {};
+  input.vertices = vertices;
+  input.num_vertices = num_vertices;
+  input.vertex_stride = vertex_stride;
+  input.position_offset = position_offset;
+  input.indices = indices;
+  input.num_triangles = num_triangles;
+  input.index_type = index_type;
+  return create_mesh_shape_strided(&input);
+}
+
 FFI_PLUGIN_EXPORT CollisionShape* create_compound_shape(CompoundShapeConfig* shapes, int num_shapes) {
   StaticCompoundShapeSettings settings;
   for (int i = 0; i < num_shapes; i++) {
@@ -393,7 +1726,7 @@ FFI_PLUGIN_EXPORT CollisionShape* create_compound_shape(CompoundShapeConfig* sha
   return new CollisionShape(result.Get());
 }
 
-FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape(ConvexShapeConfig* config, float* points, int num_points) {
+static CollisionShape* CreateConvexShape(ConvexShapeConfig* config, const MeshReader& points) {
   switch (config->type) {
     case kBox: {
       BoxShapeSettings settings(Vec3(config->payload[0], config->payload[1], config->payload[2]));
@@ -422,10 +1755,7 @@ FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape(ConvexShapeConfig* config,
     }
     case kConvexHull: {
       Array<Vec3> copiedPoints;
-      copiedPoints.reserve(num_points);
-      for (int i = 0; i < num_points; i++) {
-        copiedPoints.push_back(Vec3(points[i * 3 + 0], points[i * 3 + 1], points[i * 3 + 2]));
-      }
+      points.ReadPoints(copiedPoints);
       ConvexHullShapeSettings settings(copiedPoints);
       settings.SetDensity(config->density);
       auto result = settings.Create();
@@ -442,6 +1772,216 @@ FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape(ConvexShapeConfig* config,
   }
 }
 
+FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape_strided(ConvexShapeConfig* config, const MeshInput* points) {
+  MeshReader reader(*points);
+  ShapeKey key('C');
+  key.Add(config->type).Add(config->density);
+  if (config->type == kConvexHull) {
+    ContentHash hash;
+    reader.HashVertices(hash);
+    key.AddContentHash(hash);
+  } else {
+    key.Add(config->payload);
+  }
+  return InternShape(key, [config, &reader]() {
+    return CreateConvexShape(config, reader);
+  });
+}
+
+FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape(ConvexShapeConfig* config, float* points, int num_points) {
+  MeshInput input = PackedMeshInput(points, num_points, nullptr, 0);
+  return create_convex_shape_strided(config, &input);
+}
+
+FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape_strided_flat(ConvexShapeConfig* config, const uint8_t* vertices, int num_vertices,
+                                                                   int vertex_stride, int position_offset) {
+  MeshInput input = {};
+  input.vertices = vertices;
+  input.num_vertices = num_vertices;
+  input.vertex_stride = vertex_stride;
+  input.position_offset = position_offset;
+  return create_convex_shape_strided(config, &input);
+}
+
+static CollisionShape* CreateSimplifiedHullShape(ConvexShapeConfig* config, const MeshReader& reader, int max_vertices) {
+  VertexList positions;
+  reader.ReadVertices(positions);
+  std::vector<VHACD::Vertex> vertices;
+  vertices.reserve(positions.size());
+  for (const Float3& position : positions) {
+    vertices.emplace_back(position.x, position.y, position.z);
+  }
+  VHACD::QuickHull quickhull;
+  // 0 means no limit, like compute_single_convex_hull.
+  quickhull.ComputeConvexHull(vertices, max_vertices > 0 ? static_cast<uint32_t>(max_vertices) : static_cast<uint32_t>(vertices.size()));
+  Array<Vec3> points;
+  points.reserve(quickhull.GetVertices().size());
+  for (const VHACD::Vertex& point : quickhull.GetVertices()) {
+    points.push_back(Vec3(float(point.mX), float(point.mY), float(point.mZ)));
+  }
+  ConvexHullShapeSettings settings(points);
+  settings.SetDensity(config->density);
+  auto result = settings.Create();
+  assert_shape_result("simplified hull", result);
+  if (result.HasError()) {
+    return nullptr;
+  }
+  return new CollisionShape(result.Get());
+}
+
+FFI_PLUGIN_EXPORT CollisionShape* create_simplified_hull_shape(ConvexShapeConfig* config, const MeshInput* points, int max_vertices) {
+  MeshReader reader(*points);
+  ContentHash hash;
+  reader.HashVertices(hash);
+  ShapeKey key('S');
+  key.Add(config->density).Add(max_vertices).AddContentHash(hash);
+  return InternShape(key, [config, &reader, max_vertices]() {
+    return CreateSimplifiedHullShape(config, reader, max_vertices);
+  });
+}
+
+static CollisionShape* CreateDecomposedShape(const MeshReader& mesh, const DecompositionConfig& config) {
+  VertexList vertices;
+  mesh.ReadVertices(vertices);
+  Array<uint32_t> indices;
+  mesh.ReadIndices(indices);
+  VHACD::IVHACD::Parameters parameters;
+  // This already runs on a pool worker for the async variant, V-HACD must not
+  // start threads of its own on top.
+  parameters.m_asyncACD = false;
+  if (config.max_convex_hulls > 0) {
+    parameters.m_maxConvexHulls = config.max_convex_hulls;
+  }
+  if (config.resolution > 0) {
+    parameters.m_resolution = config.resolution;
+  }
+  if (config.max_vertices_per_hull > 0) {
+    parameters.m_maxNumVerticesPerCH = config.max_vertices_per_hull;
+  }
+  StaticCompoundShapeSettings settings;
+  VHACD::IVHACD* vhacd = VHACD::CreateVHACD();
+  if (vhacd->Compute(reinterpret_cast<const float*>(vertices.data()), vertices.size(), indices.data(), mesh.num_triangles(), parameters)) {
+    for (uint32_t i = 0; i < vhacd->GetNConvexHulls(); i++) {
+      VHACD::IVHACD::ConvexHull hull;
+      if (!vhacd->GetConvexHull(i, hull)) {
+        continue;
+      }
+      Array<Vec3> points;
+      points.reserve(hull.m_points.size());
+      for (const VHACD::Vertex& point : hull.m_points) {
+        points.push_back(Vec3(float(point.mX), float(point.mY), float(point.mZ)));
+      }
+      ConvexHullShapeSettings hull_settings(points);
+      if (config.density > 0) {
+        hull_settings.SetDensity(config.density);
+      }
+      auto result = hull_settings.Create();
+      // Skip degenerate hulls, such as flat slivers, instead of failing the
+      // whole decomposition.
+      if (result.HasError()) {
+        continue;
+      }
+      settings.AddShape(Vec3::sZero(), Quat::sIdentity(), result.Get());
+    }
+  }
+  vhacd->Release();
+  if (settings.mSubShapes.empty()) {
+    return nullptr;
+  }
+  auto result = settings.Create();
+  assert_shape_result("decomposed", result);
+  return new CollisionShape(result.Get());
+}
+
+FFI_PLUGIN_EXPORT CollisionShape* create_decomposed_shape(const MeshInput* mesh, const DecompositionConfig* config) {
+  MeshReader reader(*mesh);
+  ContentHash vertices;
+  reader.HashVertices(vertices);
+  ContentHash triangles;
+  reader.HashIndices(triangles);
+  ShapeKey key('V');
+  key.AddContentHash(vertices).AddContentHash(triangles).Add(*config);
+  return InternShape(key, [config, &reader]() {
+    return CreateDecomposedShape(reader, *config);
+  });
+}
+
+// Runs build on the shared worker pool and posts [request_id, shape address]
+// to port. The address is 0 if construction failed.
+template <typename BuildFn>
+static void BuildShapeAsync(Dart_Port_DL port, int64_t request_id, BuildFn build) {
+  SharedJobSystem::Get().job_system()->CreateJob("BuildShape", Color::sGreen, [port, request_id, build = std::move(build)]() mutable {
+    CollisionShape* shape = build();
+    Dart_CObject id;
+    id.type = Dart_CObject_kInt64;
+    id.value.as_int64 = request_id;
+    Dart_CObject address;
+    address.type = Dart_CObject_kInt64;
+    address.value.as_int64 = reinterpret_cast<int64_t>(shape);
+    Dart_CObject* values[] = {&id, &address};
+    Dart_CObject message;
+    message.type = Dart_CObject_kArray;
+    message.value.as_array.length = 2;
+    message.value.as_array.values = values;
+    if (!Dart_PostCObject_DL(port, &message) && shape != nullptr) {
+      // The port was closed, nobody will take ownership.
+      ShapeCache::Get().Release(shape);
+    }
+  });
+}
+
+FFI_PLUGIN_EXPORT void create_convex_shape_async(ConvexShapeConfig* config, float* points, int num_points, Dart_Port_DL port, int64_t request_id) {
+  // The caller may free its buffers as soon as we return.
+  ConvexShapeConfig copied_config = *config;
+  std::vector<float> copied_points(points, points + 3 * num_points);
+  BuildShapeAsync(port, request_id, [copied_config, copied_points = std::move(copied_points), num_points]() mutable {
+    return create_convex_shape(&copied_config, copied_points.data(), num_points);
+  });
+}
+
+FFI_PLUGIN_EXPORT void create_mesh_shape_async(float* vertices, int num_vertices, uint32_t* triangles, int num_triangles, Dart_Port_DL port, int64_t request_id) {
+  std::vector<float> copied_vertices(vertices, vertices + 3 * num_vertices);
+  std::vector<uint32_t> copied_triangles(triangles, triangles + 3 * num_triangles);
+  BuildShapeAsync(port, request_id, [copied_vertices = std::move(copied_vertices), num_vertices,
+                                     copied_triangles = std::move(copied_triangles), num_triangles]() mutable {
+    return create_mesh_shape(copied_vertices.data(), num_vertices, copied_triangles.data(), num_triangles);
+  });
+}
+
+FFI_PLUGIN_EXPORT void create_compound_shape_async(CompoundShapeConfig* shapes, int num_shapes, Dart_Port_DL port, int64_t request_id) {
+  std::vector<CompoundShapeConfig> copied_shapes(shapes, shapes + num_shapes);
+  // Keep the sub shapes alive until the compound holds its own references.
+  for (const CompoundShapeConfig& per_shape : copied_shapes) {
+    ShapeCache::Get().Retain(per_shape.shape);
+  }
+  BuildShapeAsync(port, request_id, [copied_shapes = std::move(copied_shapes), num_shapes]() mutable {
+    CollisionShape* shape = create_compound_shape(copied_shapes.data(), num_shapes);
+    for (const CompoundShapeConfig& per_shape : copied_shapes) {
+      ShapeCache::Get().Release(per_shape.shape);
+    }
+    return shape;
+  });
+}
+
+FFI_PLUGIN_EXPORT void create_decomposed_shape_async(const MeshInput* mesh, const DecompositionConfig* config, Dart_Port_DL port, int64_t request_id) {
+  // Pack the mesh so the job doesn't depend on the caller's layout or memory.
+  MeshReader reader(*mesh);
+  VertexList vertices;
+  reader.ReadVertices(vertices);
+  Array<uint32_t> triangles;
+  reader.ReadIndices(triangles);
+  DecompositionConfig copied_config = *config;
+  BuildShapeAsync(port, request_id, [vertices = std::move(vertices), triangles = std::move(triangles), copied_config]() {
+    MeshInput input = PackedMeshInput(reinterpret_cast<const float*>(vertices.data()), static_cast<int>(vertices.size()),
+                                      triangles.data(), static_cast<int>(triangles.size() / 3));
+    return create_decomposed_shape(&input, &copied_config);
+  });
+}
+
+FFI_PLUGIN_EXPORT void shape_cache_get_stats(ShapeCacheStats* stats) {
+  ShapeCache::Get().GetStats(stats);
+}
+
 FFI_PLUGIN_EXPORT void shape_set_dart_owner(CollisionShape *shape,
                                             Dart_Handle owner) {
   CollisionShape::SetDartOwner(shape, owner);
@@ -461,7 +2001,391 @@ FFI_PLUGIN_EXPORT void shape_get_local_bounds(CollisionShape* shape, float* min3
   *reinterpret_cast<Vec3 *>(max3) = box.mMax;
 }
 
-FFI_PLUGIN_EXPORT void destroy_shape(CollisionShape *shape) { delete shape; }
+FFI_PLUGIN_EXPORT int shape_get_num_hull_points(CollisionShape* shape) {
+  const Shape* s = shape->shape();
+  if (s->GetSubType() != EShapeSubType::ConvexHull) {
+    return 0;
+  }
+  return static_cast<const ConvexHullShape*>(s)->GetNumPoints();
+}
+
+FFI_PLUGIN_EXPORT int shape_get_num_sub_shapes(CollisionShape* shape) {
+  const Shape* s = shape->shape();
+  if (s->GetType() != EShapeType::Compound) {
+    return 0;
+  }
+  return static_cast<const CompoundShape*>(s)->GetNumSubShapes();
+}
+
+// Header of the blobs written by shape_save_binary. The Jolt stream follows.
+constexpr uint32_t kShapeBinaryMagic = 0x50485344;  // 'DSHP'
+constexpr uint32_t kShapeBinaryVersion = 1;
+
+// StreamOut that appends to a growable buffer.
+class BufferStreamOut : public StreamOut {
+public:
+  void WriteBytes(const void *inData, size_t inNumBytes) override {
+    const uint8_t *bytes = static_cast<const uint8_t *>(inData);
+    buffer_.insert(buffer_.end(), bytes, bytes + inNumBytes);
+  }
+
+  bool IsFailed() const override { return false; }
+
+  std::vector<uint8_t> &buffer() { return buffer_; }
+
+private:
+  std::vector<uint8_t> buffer_;
+};
+
+// StreamIn that reads from memory owned by the caller without copying it.
+class MemoryStreamIn : public StreamIn {
+public:
+  MemoryStreamIn(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  void ReadBytes(void *outData, size_t inNumBytes) override {
+    if (inNumBytes > size_ - offset_) {
+      failed_ = true;
+      memset(outData, 0, inNumBytes);
+      offset_ = size_;
+      return;
+    }
+    memcpy(outData, data_ + offset_, inNumBytes);
+    offset_ += inNumBytes;
+  }
+
+  bool IsEOF() const override { return offset_ >= size_; }
+
+  bool IsFailed() const override { return failed_; }
+
+private:
+  const uint8_t *data_;
+  size_t size_;
+  size_t offset_ = 0;
+  bool failed_ = false;
+};
+
+static std::vector<uint8_t> SaveShapeBinary(CollisionShape* shape) {
+  BufferStreamOut stream;
+  stream.Write(kShapeBinaryMagic);
+  stream.Write(kShapeBinaryVersion);
+  // The maps make shapes and materials that are referenced more than once in
+  // the tree get written once.
+  Shape::ShapeToIDMap shape_map;
+  Shape::MaterialToIDMap material_map;
+  shape->shape()->SaveWithChildren(stream, shape_map, material_map);
+  return std::move(stream.buffer());
+}
+
+FFI_PLUGIN_EXPORT uint8_t* shape_save_binary(CollisionShape* shape, int* out_size) {
+  std::vector<uint8_t> buffer = SaveShapeBinary(shape);
+  uint8_t* out = reinterpret_cast<uint8_t*>(malloc(buffer.size()));
+  memcpy(out, buffer.data(), buffer.size());
+  *out_size = static_cast<int>(buffer.size());
+  return out;
+}
+
+FFI_PLUGIN_EXPORT CollisionShape* shape_restore_binary(const uint8_t* data, size_t size) {
+  MemoryStreamIn stream(data, size);
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  stream.Read(magic);
+  stream.Read(version);
+  if (magic != kShapeBinaryMagic || version != kShapeBinaryVersion) {
+    fprintf(stderr, "Shape binary has unknown format %08x version %u\n", magic, version);
+    return nullptr;
+  }
+  Shape::IDToShapeMap shape_map;
+  Shape::IDToMaterialMap material_map;
+  Shape::ShapeResult result = Shape::sRestoreWithChildren(stream, shape_map, material_map);
+  if (result.HasError() || stream.IsFailed()) {
+    fprintf(stderr, "Shape binary restore failed: %s\n",
+            result.HasError() ? result.GetError().c_str() : "truncated data");
+    return nullptr;
+  }
+  // User data was saved along with the shapes. It held the Dart owners of the
+  // shapes that were saved, which mean nothing here.
+  for (const Ref<Shape> &restored : shape_map) {
+    restored->SetUserData(0);
+  }
+  return new CollisionShape(result.Get());
+}
+
+// Bundle layout, all integers little endian:
+//   ShapeBundleHeader
+//   ShapeBundleEntry[num_shapes]
+//   names, not null terminated
+//   shape data written by SaveShapeBinary, one blob per entry
+constexpr uint32_t kShapeBundleMagic = 0x4e425344;  // 'DSBN'
+constexpr uint32_t kShapeBundleVersion = 1;
+
+struct ShapeBundleHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t num_shapes;
+  uint32_t reserved;
+};
+
+struct ShapeBundleEntry {
+  uint64_t data_offset;
+  uint64_t data_size;
+  uint32_t name_offset;
+  uint32_t name_size;
+};
+
+static double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Read only memory mapping of a whole file.
+class MappedFile {
+public:
+  ~MappedFile() {
+#if _WIN32
+    if (data_ != nullptr) {
+      UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+      CloseHandle(mapping_);
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+      CloseHandle(file_);
+    }
+#else
+    if (data_ != nullptr) {
+      munmap(const_cast<uint8_t *>(data_), size_);
+    }
+#endif
+  }
+
+  bool Open(const char *path) {
+#if _WIN32
+    file_ = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+      return false;
+    }
+    size_ = static_cast<size_t>(size.QuadPart);
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+      return false;
+    }
+    data_ = static_cast<const uint8_t *>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    return data_ != nullptr;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      close(fd);
+      return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive.
+    close(fd);
+    if (data == MAP_FAILED) {
+      return false;
+    }
+    data_ = static_cast<const uint8_t *>(data);
+    return true;
+#endif
+  }
+
+  const uint8_t *data() const { return data_; }
+
+  size_t size() const { return size_; }
+
+  // Bytes of the mapping that are currently in physical memory.
+  size_t ResidentBytes() const {
+#if _WIN32
+    // Not cheap to query on Windows. Report the whole mapping.
+    return size_;
+#else
+    size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t num_pages = (size_ + page_size - 1) / page_size;
+    std::vector<unsigned char> pages(num_pages);
+#if __APPLE__
+    int result = mincore(const_cast<uint8_t *>(data_), size_, reinterpret_cast<char *>(pages.data()));
+#else
+    int result = mincore(const_cast<uint8_t *>(data_), size_, pages.data());
+#endif
+    if (result != 0) {
+      return 0;
+    }
+    size_t resident = 0;
+    for (unsigned char page : pages) {
+      resident += (page & 1) ? page_size : 0;
+    }
+    return std::min(resident, size_);
+#endif
+  }
+
+private:
+  const uint8_t *data_ = nullptr;
+  size_t size_ = 0;
+#if _WIN32
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#endif
+};
+
+// A mapped bundle file. Shapes are restored from the mapping the first time
+// they are looked up and kept until the bundle is closed.
+class ShapeBundle {
+public:
+  ~ShapeBundle() {
+    for (CollisionShape *shape : shapes_) {
+      if (shape != nullptr) {
+        ShapeCache::Get().Release(shape);
+      }
+    }
+  }
+
+  bool Open(const char *path) {
+    auto start = std::chrono::steady_clock::now();
+    if (!file_.Open(path) || file_.size() < sizeof(ShapeBundleHeader)) {
+      return false;
+    }
+    ShapeBundleHeader header;
+    memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != kShapeBundleMagic || header.version != kShapeBundleVersion) {
+      fprintf(stderr, "Shape bundle %s has unknown format %08x version %u\n", path, header.magic, header.version);
+      return false;
+    }
+    size_t toc_size = sizeof(ShapeBundleEntry) * header.num_shapes;
+    if (file_.size() - sizeof(header) < toc_size) {
+      return false;
+    }
+    entries_.resize(header.num_shapes);
+    memcpy(entries_.data(), file_.data() + sizeof(header), toc_size);
+    shapes_.resize(header.num_shapes, nullptr);
+    ids_by_name_.reserve(header.num_shapes);
+    for (uint32_t i = 0; i < header.num_shapes; i++) {
+      const ShapeBundleEntry &entry = entries_[i];
+      if (!InFile(entry.name_offset, entry.name_size) || !InFile(entry.data_offset, entry.data_size)) {
+        fprintf(stderr, "Shape bundle %s is truncated\n", path);
+        return false;
+      }
+      std::string_view name(reinterpret_cast<const char *>(file_.data() + entry.name_offset), entry.name_size);
+      ids_by_name_.emplace(name, static_cast<int>(i));
+    }
+    stats_.num_shapes = static_cast<int>(header.num_shapes);
+    stats_.mapped_bytes = static_cast<int64_t>(file_.size());
+    stats_.open_ms = MillisecondsSince(start);
+    return true;
+  }
+
+  int Find(const char *name) {
+    auto it = ids_by_name_.find(std::string_view(name));
+    return it == ids_by_name_.end() ? -1 : it->second;
+  }
+
+  CollisionShape *GetShape(int id) {
+    if (id < 0 || id >= static_cast<int>(shapes_.size())) {
+      return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shapes_[id] == nullptr) {
+      auto start = std::chrono::steady_clock::now();
+      const ShapeBundleEntry &entry = entries_[id];
+      shapes_[id] = shape_restore_binary(file_.data() + entry.data_offset, entry.data_size);
+      if (shapes_[id] == nullptr) {
+        return nullptr;
+      }
+      Shape::VisitedShapes visited;
+      stats_.restored_shape_bytes += shapes_[id]->shape()->GetStatsRecursive(visited).mSizeBytes;
+      stats_.num_restored++;
+      stats_.restore_ms += MillisecondsSince(start);
+    }
+    // One reference stays with the bundle.
+    ShapeCache::Get().Retain(shapes_[id]);
+    return shapes_[id];
+  }
+
+  void GetStats(ShapeBundleStats *stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *stats = stats_;
+    stats->resident_bytes = static_cast<int64_t>(file_.ResidentBytes());
+  }
+
+private:
+  bool InFile(uint64_t offset, uint64_t size) const {
+    return offset <= file_.size() && size <= file_.size() - offset;
+  }
+
+  MappedFile file_;
+  std::vector<ShapeBundleEntry> entries_;
+  // Names point into the mapping.
+  std::unordered_map<std::string_view, int> ids_by_name_;
+  std::mutex mutex_;
+  std::vector<CollisionShape *> shapes_;
+  ShapeBundleStats stats_ = {};
+};
+
+FFI_PLUGIN_EXPORT bool shape_bundle_write(const char* path, CollisionShape** shapes, const char** names, int num_shapes) {
+  std::vector<ShapeBundleEntry> entries(num_shapes);
+  std::vector<std::vector<uint8_t>> blobs(num_shapes);
+  uint64_t offset = sizeof(ShapeBundleHeader) + sizeof(ShapeBundleEntry) * num_shapes;
+  for (int i = 0; i < num_shapes; i++) {
+    entries[i].name_offset = static_cast<uint32_t>(offset);
+    entries[i].name_size = static_cast<uint32_t>(strlen(names[i]));
+    offset += entries[i].name_size;
+  }
+  for (int i = 0; i < num_shapes; i++) {
+    blobs[i] = SaveShapeBinary(shapes[i]);
+    entries[i].data_offset = offset;
+    entries[i].data_size = blobs[i].size();
+    offset += blobs[i].size();
+  }
+  FILE* file = fopen(path, "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  ShapeBundleHeader header = {kShapeBundleMagic, kShapeBundleVersion, static_cast<uint32_t>(num_shapes), 0};
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+  ok = ok && fwrite(entries.data(), sizeof(ShapeBundleEntry), entries.size(), file) == entries.size();
+  for (int i = 0; ok && i < num_shapes; i++) {
+    ok = fwrite(names[i], 1, entries[i].name_size, file) == entries[i].name_size;
+  }
+  for (int i = 0; ok && i < num_shapes; i++) {
+    ok = fwrite(blobs[i].data(), 1, blobs[i].size(), file) == blobs[i].size();
+  }
+  return fclose(file) == 0 && ok;
+}
+
+FFI_PLUGIN_EXPORT ShapeBundle* shape_bundle_open(const char* path) {
+  ShapeBundle* bundle = new ShapeBundle();
+  if (!bundle->Open(path)) {
+    delete bundle;
+    return nullptr;
+  }
+  return bundle;
+}
+
+FFI_PLUGIN_EXPORT int shape_bundle_find(ShapeBundle* bundle, const char* name) {
+  return bundle->Find(name);
+}
+
+FFI_PLUGIN_EXPORT CollisionShape* shape_bundle_get_shape(ShapeBundle* bundle, int id) {
+  return bundle->GetShape(id);
+}
+
+FFI_PLUGIN_EXPORT void shape_bundle_get_stats(ShapeBundle* bundle, ShapeBundleStats* stats) {
+  bundle->GetStats(stats);
+}
+
+FFI_PLUGIN_EXPORT void shape_bundle_close(ShapeBundle* bundle) {
+  delete bundle;
+}
+
+FFI_PLUGIN_EXPORT void destroy_shape(CollisionShape *shape) {
+  ShapeCache::Get().Release(shape);
+}
 
 void toJolt(BodyConfig *config, BodyCreationSettings *settings) {
   settings->SetShape(config->shape->shape());
@@ -475,7 +2399,11 @@ void toJolt(BodyConfig *config, BodyCreationSettings *settings) {
   settings->mPosition.SetComponent(2, config->position[2]);
   settings->mRotation.Set(config->rotation[0], config->rotation[1],
                           config->rotation[2], config->rotation[3]);
-  if (settings->mMotionType == EMotionType::Static) {
+  settings->mIsSensor = config->is_sensor;
+  if (config->is_sensor) {
+    // Sensors only need to detect moving objects.
+    settings->mObjectLayer = ObjectLayerPairFilterMask::sGetObjectLayer(LayerFilterSensor, LayerFilterMoving);
+  } else if (settings->mMotionType == EMotionType::Static) {
     settings->mObjectLayer = ObjectLayerPairFilterMask::sGetObjectLayer(LayerFilterStatic, LayerFilterMoving);
   } else {
     settings->mObjectLayer = ObjectLayerPairFilterMask::sGetObjectLayer(LayerFilterMoving, LayerFilterAll);
@@ -490,6 +2418,16 @@ FFI_PLUGIN_EXPORT WorldBody *world_create_body(World *world,
   return new WorldBody(world, body);
 }
 
+FFI_PLUGIN_EXPORT void world_create_bodies(World *world, BodyConfig *configs,
+                                           int num_bodies, WorldBody **out) {
+  BodyInterface &body_interface = world->body_interface();
+  for (int i = 0; i < num_bodies; i++) {
+    BodyCreationSettings settings;
+    toJolt(&configs[i], &settings);
+    out[i] = new WorldBody(world, body_interface.CreateBody(settings));
+  }
+}
+
 FFI_PLUGIN_EXPORT void body_set_position(WorldBody *body, float *v4) {
   body->SetPosition(v4);
 }
@@ -526,6 +2464,18 @@ FFI_PLUGIN_EXPORT bool body_get_active(WorldBody* body) {
   return body->interface().IsActive(body->id());
 }
 
+FFI_PLUGIN_EXPORT uint32_t body_get_index(WorldBody* body) {
+  return body->id().GetIndex();
+}
+
+FFI_PLUGIN_EXPORT void body_set_contact_events(WorldBody* body, bool enabled) {
+  body->world()->SetContactEventsEnabled(body->id(), enabled);
+}
+
+FFI_PLUGIN_EXPORT int body_get_mirror_slot(WorldBody* body) {
+  return body->world()->GetMirrorSlot(body->id());
+}
+
 FFI_PLUGIN_EXPORT void destroy_body(WorldBody *body) { delete body; }
 
 FFI_PLUGIN_EXPORT void set_body_dart_owner(WorldBody* body, Dart_Handle owner) {
@@ -535,3 +2485,13 @@ FFI_PLUGIN_EXPORT void set_body_dart_owner(WorldBody* body, Dart_Handle owner) {
 FFI_PLUGIN_EXPORT Dart_Handle get_body_dart_owner(WorldBody* body) {
   return WorldBody::GetDartOwner(body);
 }
+
+FFI_PLUGIN_EXPORT bool job_system_configure(int num_threads, int priority) {
+  return SharedJobSystem::Get().Configure(num_threads, priority);
+}
+
+FFI_PLUGIN_EXPORT void job_system_run_task(JobTask task, void* data) {
+  SharedJobSystem::Get().job_system()->CreateJob("Task", Color::sGrey, [task, data]() {
+    task(data);
+  });
+}
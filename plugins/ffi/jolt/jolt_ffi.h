@@ -31,6 +31,49 @@ extern "C" {
 typedef class_type World World;
 typedef class_type CollisionShape CollisionShape;
 typedef class_type WorldBody WorldBody;
+typedef class_type BodyBatch BodyBatch;
+typedef class_type ShapeBundle ShapeBundle;
+
+// Configuration for a world when it is created. Use world_config_init_defaults
+// to get the default values.
+typedef struct WorldConfig {
+  // Max number of rigid bodies that can be added to the world. Default 65536.
+  int max_bodies;
+  // Number of mutexes protecting rigid bodies from concurrent access. 0 picks a
+  // default based on max_bodies.
+  int num_body_mutexes;
+  // Max number of body pairs that can be queued for the narrow phase. If the
+  // queue fills up the broad phase jobs start to do narrow phase work, which is
+  // slightly less efficient. Default 65536.
+  int max_body_pairs;
+  // Size of the contact constraint buffer. Contacts beyond this are dropped and
+  // bodies will start interpenetrating. Default 10240.
+  int max_contact_constraints;
+  // Bytes of scratch memory used during a step. Default 10 MB.
+  int temp_allocator_size;
+  // Number of worker threads. 0 steps on the calling thread only, a positive
+  // value gives the world a pool of its own and -1 steps on the process wide
+  // pool configured with job_system_configure. Default -1.
+  int num_threads;
+  // Default (0, -9.81, 0).
+  float gravity[3];
+  // 1 puts every object in a single broad phase layer, 2 separates static
+  // objects and 3 also separates sensors. Default 2.
+  int num_broad_phase_layers;
+} WorldConfig;
+
+// Controls how world_step advances the simulation.
+typedef struct StepConfig {
+  // Internal time step in seconds. When > 0 world_step adds its dt to an
+  // accumulator and runs as many updates of fixed_dt as fit. When 0 world_step
+  // runs a single update of dt.
+  float fixed_dt;
+  // Max number of fixed updates per world_step. Whole steps beyond this are
+  // dropped.
+  int max_substeps;
+  // Number of collision steps per update.
+  int collision_steps;
+} StepConfig;
 
 // Configuration for a body when it si created.
 typedef struct BodyConfig {
@@ -41,6 +84,9 @@ typedef struct BodyConfig {
   float angular_velocity[4];
   int motion_type;
   int motion_quality;
+  // Sensors report overlaps through world_enable_sensor_events instead of
+  // colliding. They only detect moving bodies.
+  bool is_sensor;
 } BodyConfig;
 
 typedef enum ConvexShapeConfigType {
@@ -79,24 +125,234 @@ typedef struct DecoratedShapeConfig {
   float q4[4];
 } DecoratedShapeConfig;
 
+typedef enum MeshIndexType {
+  kMeshIndexU16,
+  kMeshIndexU32,
+} MeshIndexType;
+
+// Positions and triangles in caller owned buffers, for example interleaved
+// render buffers. Only read during the call.
+typedef struct MeshInput {
+  const void* vertices;
+  int num_vertices;
+  // Bytes from one vertex to the next, 0 for tightly packed positions.
+  int vertex_stride;
+  // Bytes from the start of a vertex to its x, y, z floats.
+  int position_offset;
+  // Three indices per triangle. Ignored for convex hulls.
+  const void* indices;
+  int num_triangles;
+  // MeshIndexType.
+  int index_type;
+} MeshInput;
+
+// Convex decomposition of a concave mesh. Zero fields use the defaults.
+typedef struct DecompositionConfig {
+  // Upper bound on the number of convex hulls.
+  int max_convex_hulls;
+  // Number of voxels used to approximate the mesh.
+  int resolution;
+  // Upper bound on the vertices of each hull.
+  int max_vertices_per_hull;
+  // Density of every hull.
+  float density;
+} DecompositionConfig;
+
+typedef struct ShapeCacheStats {
+  // create_convex_shape, create_decorated_shape and create_mesh_shape calls
+  // that returned an existing shape.
+  int64_t hits;
+  int64_t misses;
+  // Number of distinct interned shapes alive.
+  int num_shapes;
+} ShapeCacheStats;
+
+typedef struct ShapeBundleStats {
+  // Number of shapes in the bundle.
+  int num_shapes;
+  // Number of shapes restored so far.
+  int num_restored;
+  // Time spent mapping the file and reading the table of contents.
+  double open_ms;
+  // Total time spent restoring shapes.
+  double restore_ms;
+  // Size of the mapped file and how much of it is currently in memory.
+  int64_t mapped_bytes;
+  int64_t resident_bytes;
+  // Memory used by the restored shapes.
+  int64_t restored_shape_bytes;
+} ShapeBundleStats;
+
 typedef struct CompoundShapeConfig {
   CollisionShape* shape;
   float position[3];
   float rotation[4];
 } CompoundShapeConfig;
 
+typedef enum RayCastFlags {
+  // The caller guarantees that no step is running. Hits are collected first
+  // and normals are resolved afterwards without taking body locks. Set in
+  // RayCastConfig.flags or or'ed into the mode of world_raycast_batch.
+  kRayCastNoLock = 1 << 8,
+} RayCastFlags;
+
 typedef struct RayCastConfig {
   float start[3];
   float end[3];
+  // RayCastFlags.
+  int flags;
   float (*cb)(Dart_Handle body, float fraction, const float* n);
 } RayCastConfig;
 
+typedef struct Ray {
+  float start[3];
+  float end[3];
+} Ray;
+
+typedef enum RayCastMode {
+  // Report the closest hit along the ray.
+  kRayCastClosest,
+  // Report any hit along the ray. Cheaper, for line of sight checks.
+  kRayCastAny,
+} RayCastMode;
+
+// Result of a single ray in world_raycast_batch.
+typedef struct RayCastHit {
+  // Index of the body that was hit as returned by body_get_index, -1 if the
+  // ray didn't hit anything.
+  int32_t body_index;
+  uint32_t sub_shape_id;
+  float fraction;
+  // World space surface normal at the hit.
+  float normal[3];
+} RayCastHit;
+
+typedef enum ContactEventType {
+  kContactAdded,
+  kContactPersisted,
+  kContactRemoved,
+} ContactEventType;
+
+typedef struct ContactEvent {
+  // ContactEventType.
+  int type;
+  // Indices of the bodies as returned by body_get_index.
+  uint32_t body_index1;
+  uint32_t body_index2;
+  uint32_t sub_shape_id1;
+  uint32_t sub_shape_id2;
+  // World space contact point on body 1. Zero for kContactRemoved.
+  float point[3];
+  // Contact normal pointing from body 1 to body 2. Zero for kContactRemoved.
+  float normal[3];
+  // Estimated impulse needed to stop the bodies from approaching each other
+  // along the normal. Zero for kContactRemoved.
+  float impulse;
+} ContactEvent;
+
+// Contact events recorded during the last world_step. Owned by the World and
+// never reallocated.
+typedef struct ContactEventBuffer {
+  ContactEvent* events;
+  int capacity;
+  // Number of valid entries in events.
+  int count;
+  // Number of events that didn't fit in the buffer.
+  int dropped;
+} ContactEventBuffer;
+
+// Activity state of the bodies in a World. Owned by the World.
+typedef struct ActivationEvents {
+  // One bit per body index, set while the body is active. Updated as soon as
+  // a body is activated or deactivated.
+  uint64_t* active_bits;
+  int num_words;
+  // Indices of the bodies that were activated or deactivated between the two
+  // most recent world_step calls. Valid until the next step. A body that
+  // changed state more than once shows up in both lists, active_bits has its
+  // final state.
+  uint32_t* activated;
+  int num_activated;
+  uint32_t* deactivated;
+  int num_deactivated;
+} ActivationEvents;
+
+typedef enum SensorEventType {
+  kSensorEnter,
+  kSensorExit,
+} SensorEventType;
+
+typedef struct SensorEvent {
+  // SensorEventType.
+  int type;
+  // Indices of the bodies as returned by body_get_index.
+  uint32_t sensor_index;
+  uint32_t other_index;
+} SensorEvent;
+
+// Sensor overlaps that started or ended during the last world_step. Owned by
+// the World, events is valid until the next step.
+typedef struct SensorEvents {
+  SensorEvent* events;
+  int count;
+} SensorEvents;
+
+// World transform of an active body as written by world_get_active_transforms.
+typedef struct BodyTransform {
+  // Index of the body as returned by body_get_index.
+  uint32_t body_index;
+  // Column major world matrix.
+  float m16[16];
+} BodyTransform;
+
+// Triple buffered copy of body transforms owned by the World and refreshed at
+// the end of every world_step. Arrays are indexed by body_get_mirror_slot and
+// are never reallocated.
+typedef struct TransformMirror {
+  // Incremented after every step. Readers use positions[generation % 3] for
+  // the last step and positions[(generation + 2) % 3] for the one before. A
+  // step in flight only writes positions[(generation + 1) % 3].
+  uint64_t generation;
+  // Number of slots in each array.
+  int capacity;
+  // 4 floats per slot (x, y, z, unused).
+  float* positions[3];
+  // 4 floats per slot (x, y, z, w).
+  float* rotations[3];
+  // 16 floats per slot, column major. Null unless matrices were requested.
+  float* matrices[3];
+} TransformMirror;
+
+typedef enum JobPriority {
+  kJobPriorityNormal = 0,
+  kJobPriorityLow = 1,
+  kJobPriorityHigh = 2,
+} JobPriority;
+
+// Unit of work for job_system_run_task.
+typedef void (*JobTask)(void* data);
+
 FFI_PLUGIN_EXPORT uint8_t* native_malloc(int byte_size);
 
 FFI_PLUGIN_EXPORT void native_free(void* p);
 
+// Shared job system.
+// Sets the size and thread priority of the process wide worker pool used by
+// worlds with num_threads -1 and by the async shape functions. num_threads -1
+// uses one thread less than the number of hardware threads and the pool
+// always keeps at least one. Only applies before the pool is first used,
+// returns false and changes nothing once it is running.
+FFI_PLUGIN_EXPORT bool job_system_configure(int num_threads, int priority);
+
+// Runs task(data) on the shared pool. Matches the executor signature expected
+// by convex_hull_set_executor so decomposition jobs can share the pool.
+FFI_PLUGIN_EXPORT void job_system_run_task(JobTask task, void* data);
+
 // World.
-FFI_PLUGIN_EXPORT World* create_world();
+FFI_PLUGIN_EXPORT void world_config_init_defaults(WorldConfig* config);
+
+// config may be null to use the defaults.
+FFI_PLUGIN_EXPORT World* create_world(WorldConfig* config);
 
 FFI_PLUGIN_EXPORT WorldBody* world_create_body(World* world, BodyConfig* conifg);
 
@@ -104,11 +360,76 @@ FFI_PLUGIN_EXPORT void world_add_body(World* world, WorldBody* body, int activat
 
 FFI_PLUGIN_EXPORT void world_remove_body(World* world, WorldBody* body);
 
+// Creates num_bodies bodies and stores them in out.
+FFI_PLUGIN_EXPORT void world_create_bodies(World* world, BodyConfig* configs, int num_bodies, WorldBody** out);
+
+// Adds num_bodies bodies to the world, updating the broadphase once.
+FFI_PLUGIN_EXPORT void world_add_bodies(World* world, WorldBody** bodies, int num_bodies, int activation);
+
+// Split version of world_add_bodies. The prepare phase builds the broadphase
+// tree for the batch and is safe to call from any thread. The returned batch
+// must be passed to exactly one of world_add_bodies_finalize or
+// world_add_bodies_abort, which must not race with world_step.
+FFI_PLUGIN_EXPORT BodyBatch* world_add_bodies_prepare(World* world, WorldBody** bodies, int num_bodies);
+
+FFI_PLUGIN_EXPORT void world_add_bodies_finalize(World* world, BodyBatch* batch, int activation);
+
+FFI_PLUGIN_EXPORT void world_add_bodies_abort(World* world, BodyBatch* batch);
+
+// Allocates the transform mirror on first call. Later calls return the existing
+// mirror and ignore the arguments. Bodies whose slot is >= capacity are not
+// mirrored.
+FFI_PLUGIN_EXPORT TransformMirror* world_enable_transform_mirror(World* world, int capacity, bool matrices);
+
 FFI_PLUGIN_EXPORT int world_step(World* world, float dt);
 
+// Resets the fixed step accumulator.
+FFI_PLUGIN_EXPORT void world_set_step_config(World* world, StepConfig* config);
+
+// Fraction of a fixed step left in the accumulator, for interpolating between
+// the previous and current transforms. Always 1 when not in fixed step mode.
+FFI_PLUGIN_EXPORT float world_get_interpolation_alpha(World* world);
+
+// Runs world_step on a dedicated thread and posts its result to port as an
+// integer when done. port may be ILLEGAL_PORT to rely on world_step_wait or
+// world_step_poll instead. Returns false if a step is already in flight.
+// Bodies, shapes used by bodies in this world and queries against it must not
+// be touched until the step is done. The front half of the transform mirror
+// stays readable.
+FFI_PLUGIN_EXPORT bool world_step_async(World* world, float dt, Dart_Port_DL port);
+
+// Blocks until the in flight async step is done and returns its result.
+FFI_PLUGIN_EXPORT int world_step_wait(World* world);
+
+// Returns true if no async step is in flight.
+FFI_PLUGIN_EXPORT bool world_step_poll(World* world);
+
+// Installs a contact listener that records events for bodies that opted in
+// with body_set_contact_events. Later calls return the existing buffer and
+// ignore capacity.
+FFI_PLUGIN_EXPORT ContactEventBuffer* world_enable_contact_events(World* world, int capacity);
+
+// Installs a body activation listener. Later calls return the existing
+// events.
+FFI_PLUGIN_EXPORT ActivationEvents* world_enable_activation_events(World* world);
+
+// Starts tracking which bodies overlap sensors. Overlaps that exist before
+// the first call are not reported. Later calls return the existing events.
+FFI_PLUGIN_EXPORT SensorEvents* world_enable_sensor_events(World* world);
+
+// Writes the transforms of all active bodies into out and returns how many were
+// written. If there are more than max_transforms active bodies nothing is
+// written and the number of active bodies is returned instead.
+FFI_PLUGIN_EXPORT int world_get_active_transforms(World* world, BodyTransform* out, int max_transforms);
+
 FFI_PLUGIN_EXPORT void world_raycast(World* world,
                                      RayCastConfig* config);
 
+// Casts num_rays rays spread across the world's job system and writes one hit
+// per ray into out. mode is a RayCastMode, optionally or'ed with
+// kRayCastNoLock. Must not be called while a step is in flight.
+FFI_PLUGIN_EXPORT void world_raycast_batch(World* world, const Ray* rays, int num_rays, RayCastHit* out, int mode);
+
 FFI_PLUGIN_EXPORT void destroy_world(World* world);
 
 FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape(ConvexShapeConfig* config, float* points, int num_points);
@@ -117,16 +438,104 @@ FFI_PLUGIN_EXPORT CollisionShape* create_compound_shape(CompoundShapeConfig* sha
 
 FFI_PLUGIN_EXPORT CollisionShape* create_mesh_shape(float* vertices, int num_vertices, uint32_t* triangles, int num_triangles);
 
+// Variants of create_convex_shape and create_mesh_shape that read straight
+// from strided buffers with 16 or 32 bit indices. Equal geometry gets the
+// same interned shape whatever its layout.
+FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape_strided(ConvexShapeConfig* config, const MeshInput* points);
+
+FFI_PLUGIN_EXPORT CollisionShape* create_mesh_shape_strided(const MeshInput* input);
+
+// The two functions above with the MeshInput fields as arguments, so that
+// Dart can pass its typed data straight to a leaf call instead of copying it
+// to native memory first. index_type is a MeshIndexType.
+FFI_PLUGIN_EXPORT CollisionShape* create_convex_shape_strided_flat(ConvexShapeConfig* config, const uint8_t* vertices, int num_vertices,
+                                                                   int vertex_stride, int position_offset);
+
+FFI_PLUGIN_EXPORT CollisionShape* create_mesh_shape_strided_flat(const uint8_t* vertices, int num_vertices, int vertex_stride, int position_offset,
+                                                                 const uint8_t* indices, int num_triangles, int index_type);
+
 FFI_PLUGIN_EXPORT CollisionShape* create_decorated_shape(DecoratedShapeConfig* config);
 
+// Like create_convex_shape_strided for kConvexHull, but first reduces the
+// points to a hull of at most max_vertices with quickhull, for detailed
+// meshes that only need a rough hull. 0 means no limit.
+FFI_PLUGIN_EXPORT CollisionShape* create_simplified_hull_shape(ConvexShapeConfig* config, const MeshInput* points, int max_vertices);
+
+// Decomposes a concave triangle mesh into convex hulls with V-HACD and
+// returns them as one static compound shape. Returns null if no hull could
+// be built. V-HACD runs on the calling thread only, it starts no threads of
+// its own. Blocks the calling thread for the whole decomposition, see
+// create_decomposed_shape_async.
+FFI_PLUGIN_EXPORT CollisionShape* create_decomposed_shape(const MeshInput* mesh, const DecompositionConfig* config);
+
+// Async variants of the functions above. The shape is built on a native
+// worker pool, several shapes can be built at the same time. The inputs are
+// copied before returning. When done [request_id, shape] is posted to port as
+// a list of two integers, where shape is the CollisionShape* address or 0 if
+// construction failed.
+FFI_PLUGIN_EXPORT void create_convex_shape_async(ConvexShapeConfig* config, float* points, int num_points, Dart_Port_DL port, int64_t request_id);
+
+FFI_PLUGIN_EXPORT void create_mesh_shape_async(float* vertices, int num_vertices, uint32_t* triangles, int num_triangles, Dart_Port_DL port, int64_t request_id);
+
+FFI_PLUGIN_EXPORT void create_compound_shape_async(CompoundShapeConfig* shapes, int num_shapes, Dart_Port_DL port, int64_t request_id);
+
+// Runs V-HACD on the worker pool, which can take seconds for large meshes.
+FFI_PLUGIN_EXPORT void create_decomposed_shape_async(const MeshInput* mesh, const DecompositionConfig* config, Dart_Port_DL port, int64_t request_id);
+
+// Convex, mesh and decorated shapes are interned. Creating a shape with the
+// same parameters as a live one returns that shape with another reference.
+// Hull points and mesh data are compared by a 64 bit content hash.
+FFI_PLUGIN_EXPORT void shape_cache_get_stats(ShapeCacheStats* stats);
+
 FFI_PLUGIN_EXPORT void shape_get_center_of_mass(CollisionShape* shape, float* v3);
 
 FFI_PLUGIN_EXPORT void shape_get_local_bounds(CollisionShape* shape, float* min3, float* max3);
 
+// Number of points of a convex hull shape, 0 for other shapes.
+FFI_PLUGIN_EXPORT int shape_get_num_hull_points(CollisionShape* shape);
+
+// Number of sub shapes of a compound shape, 0 for other shapes.
+FFI_PLUGIN_EXPORT int shape_get_num_sub_shapes(CollisionShape* shape);
+
 FFI_PLUGIN_EXPORT void shape_set_dart_owner(CollisionShape* shape, Dart_Handle owner);
 
 FFI_PLUGIN_EXPORT Dart_Handle shape_get_dart_owner(CollisionShape* shape);
 
+// Serializes shape and its sub shapes into a buffer allocated with
+// native_malloc. Sub shapes that are referenced more than once, including
+// mesh and compound BVHs, are written once. The caller frees the result with
+// native_free.
+FFI_PLUGIN_EXPORT uint8_t* shape_save_binary(CollisionShape* shape, int* out_size);
+
+// Recreates a shape written by shape_save_binary without rebuilding it. The
+// data is not referenced after the call. Returns null if the data is invalid
+// or was written by an incompatible version.
+FFI_PLUGIN_EXPORT CollisionShape* shape_restore_binary(const uint8_t* data, size_t size);
+
+// Writes a bundle of shapes, each serialized like shape_save_binary, and a
+// table of contents mapping names to shape ids. Ids are the indices into
+// shapes. Returns false if the file couldn't be written.
+FFI_PLUGIN_EXPORT bool shape_bundle_write(const char* path, CollisionShape** shapes, const char** names, int num_shapes);
+
+// Memory maps a bundle written by shape_bundle_write. Only the table of
+// contents is read, shapes are restored on first lookup. Returns null if the
+// file can't be mapped or isn't a bundle.
+FFI_PLUGIN_EXPORT ShapeBundle* shape_bundle_open(const char* path);
+
+// Returns the id of the shape called name or -1.
+FFI_PLUGIN_EXPORT int shape_bundle_find(ShapeBundle* bundle, const char* name);
+
+// Returns a new reference to the shape with the given id, restoring it if
+// this is the first lookup. Release it with destroy_shape. Returns null if id
+// is out of range or the shape data is invalid.
+FFI_PLUGIN_EXPORT CollisionShape* shape_bundle_get_shape(ShapeBundle* bundle, int id);
+
+FFI_PLUGIN_EXPORT void shape_bundle_get_stats(ShapeBundle* bundle, ShapeBundleStats* stats);
+
+// Unmaps the bundle. Shapes that were handed out stay valid.
+FFI_PLUGIN_EXPORT void shape_bundle_close(ShapeBundle* bundle);
+
+// Drops one reference to the shape.
 FFI_PLUGIN_EXPORT void destroy_shape(CollisionShape* shape);
 
 // Bodies.
@@ -146,6 +555,15 @@ FFI_PLUGIN_EXPORT void body_set_active(WorldBody* body, bool activate);
 
 FFI_PLUGIN_EXPORT bool body_get_active(WorldBody* body);
 
+FFI_PLUGIN_EXPORT uint32_t body_get_index(WorldBody* body);
+
+// Opts the body in or out of contact events. A pair is recorded when either
+// body opted in.
+FFI_PLUGIN_EXPORT void body_set_contact_events(WorldBody* body, bool enabled);
+
+// Slot of the body in the world's TransformMirror, -1 if it is not in a world.
+FFI_PLUGIN_EXPORT int body_get_mirror_slot(WorldBody* body);
+
 FFI_PLUGIN_EXPORT void set_body_dart_owner(WorldBody* body, Dart_Handle owner);
 
 FFI_PLUGIN_EXPORT Dart_Handle get_body_dart_owner(WorldBody* body);
@@ -4,111 +4,932 @@
 
 #include "VHACD.h"
 
-static VHACD::IVHACD* vhacdImpl = VHACD::CreateVHACD();
-
-ConvexHull* makeConvexHull(const VHACD::IVHACD::ConvexHull& in) {
-  ConvexHull* out = new ConvexHull();
-  out->index = in.m_meshId;
-  out->volume = in.m_volume;
-  out->center[0] = in.m_center[0];
-  out->center[1] = in.m_center[1];
-  out->center[2] = in.m_center[2];
-  out->aabb_min[0] = in.mBmin[0];
-  out->aabb_min[1] = in.mBmin[1];
-  out->aabb_min[2] = in.mBmin[2];
-  out->aabb_max[0] = in.mBmax[0];
-  out->aabb_max[1] = in.mBmax[1];
-  out->aabb_max[2] = in.mBmax[2];
-  out->indices_size = in.m_triangles.size() * 3;
-  out->vertices_size = in.m_points.size() * 3;
-  out->indices = new uint32_t[out->indices_size];
-  int oi = 0;
-  for (int i = 0; i < in.m_triangles.size(); i++) {
-    out->indices[oi++] = in.m_triangles[i].mI0;
-    out->indices[oi++] = in.m_triangles[i].mI1;
-    out->indices[oi++] = in.m_triangles[i].mI2;
-  }
-  assert(oi == out->indices_size);
-  out->vertices = new float[out->vertices_size];
-  oi = 0;
-  for (int i = 0; i < in.m_points.size(); i++) {
-    out->vertices[oi++] = in.m_points[i].mX;
-    out->vertices[oi++] = in.m_points[i].mY;
-    out->vertices[oi++] = in.m_points[i].mZ;
-  }
-  assert(oi == out->vertices_size);
-  return out;
+#if !_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::atomic<ConvexHullExecutor>& Executor() {
+  static std::atomic<ConvexHullExecutor> executor{nullptr};
+  return executor;
 }
 
-void freeConvexHull(ConvexHull* hull) {
-  delete []hull->indices;
-  delete []hull->vertices;
-  delete hull;
+// Runs task on the executor, or on a detached thread when none is set.
+static void RunTask(std::function<void()> task) {
+  ConvexHullTask run = [](void* data) {
+    auto* task = static_cast<std::function<void()>*>(data);
+    (*task)();
+    delete task;
+  };
+  void* data = new std::function<void()>(std::move(task));
+  ConvexHullExecutor executor = Executor().load();
+  if (executor != nullptr) {
+    executor(run, data);
+  } else {
+    std::thread(run, data).detach();
+  }
 }
 
-class ConvexHullResult {
+// Idle IVHACD instances. Every decomposition checks one out, so several can
+// run at the same time from any thread. Instances are only created when a
+// decomposition needs one.
+class VHACDPool {
  public:
-  ~ConvexHullResult() {
-    for (auto& it : hulls_) {
-      freeConvexHull(it);
+  // Intentionally leaked so that exit doesn't race running decompositions.
+  static VHACDPool& Get() {
+    static VHACDPool* pool = new VHACDPool();
+    return *pool;
+  }
+
+  VHACD::IVHACD* Acquire() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!idle_.empty()) {
+        VHACD::IVHACD* vhacd = idle_.back();
+        idle_.pop_back();
+        return vhacd;
+      }
     }
-    hulls_.clear();
+    return VHACD::CreateVHACD();
   }
-  int GetNumConvexHulls() {
-    return hulls_.size();
+
+  void Release(VHACD::IVHACD* vhacd) {
+    // Drop the cached results of the last decomposition.
+    vhacd->Clean();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (idle_.size() < max_idle_) {
+        idle_.push_back(vhacd);
+        return;
+      }
+    }
+    vhacd->Release();
   }
 
-  ConvexHull* GetConvexHull(int i) {
-    return hulls_[i];
+ private:
+  VHACDPool() : max_idle_(std::max(1u, std::thread::hardware_concurrency())) {}
+
+  std::mutex mutex_;
+  std::vector<VHACD::IVHACD*> idle_;
+  const size_t max_idle_;
+};
+
+// Checks an instance out of the pool for the lifetime of this object.
+class PooledVHACD {
+ public:
+  PooledVHACD() : vhacd_(VHACDPool::Get().Acquire()) {}
+
+  ~PooledVHACD() {
+    if (discard_) {
+      vhacd_->Release();
+    } else {
+      VHACDPool::Get().Release(vhacd_);
+    }
   }
 
-  bool Compute(const float* const points,
-               const uint32_t countPoints,
-               const uint32_t* const triangles,
-               const uint32_t countTriangles,
-               const VHACD::IVHACD::Parameters& parameters) {
-    bool r = vhacdImpl->Compute(points, countPoints, triangles, countTriangles, parameters);
-    if (!r) {
-      return r;
+  // Destroys the instance instead of returning it to the pool, for instances
+  // left in a cancelled state.
+  void Discard() { discard_ = true; }
+
+  VHACD::IVHACD* get() const { return vhacd_; }
+
+  VHACD::IVHACD* operator->() const { return vhacd_; }
+
+ private:
+  VHACD::IVHACD* vhacd_;
+  bool discard_ = false;
+};
+
+// Copies hulls into a single allocation laid out as described by
+// ConvexHullResult, freed with a single free(). Returns null if the
+// allocation fails.
+static ConvexHullResult* PackConvexHullResult(const std::vector<VHACD::IVHACD::ConvexHull>& hulls) {
+  size_t vertices_size = 0;
+  size_t indices_size = 0;
+  for (const auto& hull : hulls) {
+    vertices_size += hull.m_points.size() * 3;
+    indices_size += hull.m_triangles.size() * 3;
+  }
+  size_t size = sizeof(ConvexHullResult) + sizeof(ConvexHull) * hulls.size() +
+                sizeof(float) * vertices_size + sizeof(uint32_t) * indices_size;
+  uint8_t* arena = static_cast<uint8_t*>(malloc(size));
+  if (arena == nullptr) {
+    return nullptr;
+  }
+  ConvexHullResult* result = reinterpret_cast<ConvexHullResult*>(arena);
+  result->num_hulls = hulls.size();
+  result->vertices_size = vertices_size;
+  result->indices_size = indices_size;
+  result->mapped = 0;
+  result->size = size;
+  result->hulls = reinterpret_cast<ConvexHull*>(arena + sizeof(ConvexHullResult));
+  result->vertices = reinterpret_cast<float*>(result->hulls + hulls.size());
+  result->indices = reinterpret_cast<uint32_t*>(result->vertices + vertices_size);
+  float* vertices = result->vertices;
+  uint32_t* indices = result->indices;
+  for (size_t i = 0; i < hulls.size(); i++) {
+    const VHACD::IVHACD::ConvexHull& in = hulls[i];
+    ConvexHull& out = result->hulls[i];
+    out.index = in.m_meshId;
+    out.volume = in.m_volume;
+    for (int j = 0; j < 3; j++) {
+      out.center[j] = in.m_center[j];
+      out.aabb_min[j] = in.mBmin[j];
+      out.aabb_max[j] = in.mBmax[j];
     }
-    hulls_.resize(vhacdImpl->GetNConvexHulls());
-    for (int i = 0; i < vhacdImpl->GetNConvexHulls(); i++) {
-      VHACD::IVHACD::ConvexHull in;
-      r = vhacdImpl->GetConvexHull(i, in);
-      if (!r) {
-        return r;
-      }
-      hulls_[i] = makeConvexHull(in);
+    out.vertices = vertices;
+    out.vertices_size = in.m_points.size() * 3;
+    for (const auto& point : in.m_points) {
+      *vertices++ = point.mX;
+      *vertices++ = point.mY;
+      *vertices++ = point.mZ;
+    }
+    out.indices = indices;
+    out.indices_size = in.m_triangles.size() * 3;
+    for (const auto& triangle : in.m_triangles) {
+      *indices++ = triangle.mI0;
+      *indices++ = triangle.mI1;
+      *indices++ = triangle.mI2;
+    }
+  }
+  assert(vertices == result->vertices + vertices_size);
+  assert(indices == result->indices + indices_size);
+  return result;
+}
+
+// Decomposes with vhacd and packs the hulls. Returns null on failure.
+static ConvexHullResult* ComputeConvexHullResult(VHACD::IVHACD* vhacd,
+                                                 const float* const points,
+                                                 const uint32_t countPoints,
+                                                 const uint32_t* const triangles,
+                                                 const uint32_t countTriangles,
+                                                 const VHACD::IVHACD::Parameters& parameters) {
+  if (!vhacd->Compute(points, countPoints, triangles, countTriangles, parameters)) {
+    return nullptr;
+  }
+  std::vector<VHACD::IVHACD::ConvexHull> hulls(vhacd->GetNConvexHulls());
+  for (uint32_t i = 0; i < hulls.size(); i++) {
+    if (!vhacd->GetConvexHull(i, hulls[i])) {
+      return nullptr;
     }
-    // We have a copy of the convex hull data that we own. Relaese cached results in the global vhacdImpl.
-    vhacdImpl->Clean();
-    return true;
   }
+  // The pool releases the results cached in vhacd when it is returned.
+  return PackConvexHullResult(hulls);
+}
+
+// Incremental 64 bit FNV-1a hash.
+class ContentHash {
+ public:
+  void Update(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash_ = (hash_ ^ bytes[i]) * 1099511628211ull;
+    }
+  }
+
+  template <typename T>
+  void Add(const T& value) {
+    Update(&value, sizeof(T));
+  }
+
+  uint64_t value() const { return hash_; }
 
  private:
-  std::vector<ConvexHull*> hulls_;
+  uint64_t hash_ = 14695981039346656037ull;
+};
+
+static uint64_t ConvexHullCacheKey(const float* const points,
+                                   const uint32_t countPoints,
+                                   const uint32_t* const triangles,
+                                   const uint32_t countTriangles,
+                                   const ConvexHullParameters& parameters) {
+  ContentHash hash;
+  hash.Add(countPoints);
+  hash.Update(points, sizeof(float) * 3 * countPoints);
+  hash.Add(countTriangles);
+  hash.Update(triangles, sizeof(uint32_t) * 3 * countTriangles);
+  // Field by field, the struct has padding.
+  hash.Add(parameters.max_convex_hulls);
+  hash.Add(parameters.resolution);
+  hash.Add(parameters.max_vertices_per_hull);
+  hash.Add(parameters.min_volume_percent_error);
+  hash.Add(parameters.max_recursion_depth);
+  hash.Add(parameters.fill_mode);
+  hash.Add(parameters.async);
+  return hash.value();
+}
+
+// A cache file is this header followed by a ConvexHullResult block whose
+// pointers are stored as offsets from the start of the block.
+struct ConvexHullCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  // Bytes in the ConvexHullResult block.
+  uint64_t size;
+  // ContentHash of the block as stored, catches torn or mixed writes.
+  uint64_t checksum;
+};
+
+static constexpr uint32_t kConvexHullCacheMagic = 0x43434856;  // 'VHCC'
+static constexpr uint32_t kConvexHullCacheVersion = 2;
+
+static uint64_t ConvexHullCacheChecksum(const void* block, uint64_t size) {
+  ContentHash hash;
+  hash.Update(block, size);
+  return hash.value();
+}
+
+template <typename T>
+static T* ToOffset(const ConvexHullResult* base, T* pointer) {
+  return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(pointer) - reinterpret_cast<uintptr_t>(base));
+}
+
+// Turns an offset back into a pointer, checking that bytes from there fit
+// in the block.
+template <typename T>
+static bool FromOffset(ConvexHullResult* base, T*& field, uint64_t bytes) {
+  uint64_t offset = reinterpret_cast<uintptr_t>(field);
+  if (offset > base->size || bytes > base->size - offset) {
+    return false;
+  }
+  field = reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(base) + offset);
+  return true;
+}
+
+static bool RelocateConvexHullResult(ConvexHullResult* result) {
+  if (!FromOffset(result, result->hulls, sizeof(ConvexHull) * uint64_t(result->num_hulls)) ||
+      !FromOffset(result, result->vertices, sizeof(float) * uint64_t(result->vertices_size)) ||
+      !FromOffset(result, result->indices, sizeof(uint32_t) * uint64_t(result->indices_size))) {
+    return false;
+  }
+  for (uint32_t i = 0; i < result->num_hulls; i++) {
+    ConvexHull& hull = result->hulls[i];
+    if (!FromOffset(result, hull.vertices, sizeof(float) * uint64_t(hull.vertices_size)) ||
+        !FromOffset(result, hull.indices, sizeof(uint32_t) * uint64_t(hull.indices_size))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void DestroyConvexHullResult(ConvexHullResult* result) {
+  if (result == nullptr) {
+    return;
+  }
+#if !_WIN32
+  if (result->mapped) {
+    uint8_t* mapping = reinterpret_cast<uint8_t*>(result) - sizeof(ConvexHullCacheHeader);
+    munmap(mapping, sizeof(ConvexHullCacheHeader) + result->size);
+    return;
+  }
+#endif
+  free(result);
+}
+
+// Decompositions stored on disk, one file per key. Files are touched when
+// they are used so that their modification time orders them for eviction.
+class ConvexHullCache {
+ public:
+  // Intentionally leaked, like VHACDPool.
+  static ConvexHullCache& Get() {
+    static ConvexHullCache* cache = new ConvexHullCache();
+    return *cache;
+  }
+
+  void Configure(const char* directory, int64_t max_bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory != nullptr ? directory : "";
+    max_bytes_ = max_bytes;
+    if (!directory_.empty()) {
+      std::error_code error;
+      std::filesystem::create_directories(directory_, error);
+    }
+  }
+
+  void GetStats(ConvexHullCacheStats* stats) const {
+    stats->hits = hits_;
+    stats->misses = misses_;
+    stats->evictions = evictions_;
+  }
+
+  // Returns the stored result for key, or null if there is none.
+  ConvexHullResult* Load(uint64_t key) {
+    std::string path = Path(key);
+    if (path.empty()) {
+      return nullptr;
+    }
+    ConvexHullResult* result = Read(path, key);
+    if (result != nullptr) {
+      hits_++;
+      std::error_code error;
+      std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    }
+    return result;
+  }
+
+  void Store(uint64_t key, const ConvexHullResult* result) {
+    std::string path = Path(key);
+    if (path.empty()) {
+      return;
+    }
+    misses_++;
+    std::vector<uint8_t> block(reinterpret_cast<const uint8_t*>(result),
+                               reinterpret_cast<const uint8_t*>(result) + result->size);
+    ConvexHullResult* copy = reinterpret_cast<ConvexHullResult*>(block.data());
+    ConvexHull* hulls = reinterpret_cast<ConvexHull*>(block.data() + (reinterpret_cast<const uint8_t*>(result->hulls) - reinterpret_cast<const uint8_t*>(result)));
+    for (uint32_t i = 0; i < copy->num_hulls; i++) {
+      hulls[i].vertices = ToOffset(result, hulls[i].vertices);
+      hulls[i].indices = ToOffset(result, hulls[i].indices);
+    }
+    copy->hulls = ToOffset(result, copy->hulls);
+    copy->vertices = ToOffset(result, copy->vertices);
+    copy->indices = ToOffset(result, copy->indices);
+    ConvexHullCacheHeader header = {kConvexHullCacheMagic, kConvexHullCacheVersion, key, result->size,
+                                     ConvexHullCacheChecksum(block.data(), block.size())};
+    // Write to a private file first so that readers never see a partial one.
+    std::string temp_path;
+    FILE* file = CreateTempFile(path, temp_path);
+    if (file == nullptr) {
+      return;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(block.data(), block.size(), 1, file) == 1;
+    written = fclose(file) == 0 && written;
+    std::error_code error;
+    if (!written) {
+      std::filesystem::remove(temp_path, error);
+      return;
+    }
+    std::filesystem::rename(temp_path, path, error);
+    Evict();
+  }
+
+ private:
+  std::string Path(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (directory_.empty()) {
+      return std::string();
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.vhacd", static_cast<unsigned long long>(key));
+    return (std::filesystem::path(directory_) / name).string();
+  }
+
+  // Creates a file next to path that no other thread or process can have
+  // open, so that concurrent stores of the same key never share one.
+  static FILE* CreateTempFile(const std::string& path, std::string& temp_path) {
+#if _WIN32
+    static std::atomic<uint64_t> counter{0};
+    temp_path = path + "." + std::to_string(GetCurrentProcessId()) + "." + std::to_string(counter++) + ".tmp";
+    // x fails if the file exists instead of sharing it.
+    return fopen(temp_path.c_str(), "wbx");
+#else
+    std::vector<char> name(path.begin(), path.end());
+    const char suffix[] = ".XXXXXX";
+    name.insert(name.end(), suffix, suffix + sizeof(suffix));
+    int fd = mkstemp(name.data());
+    if (fd < 0) {
+      return nullptr;
+    }
+    temp_path = name.data();
+    FILE* file = fdopen(fd, "wb");
+    if (file == nullptr) {
+      close(fd);
+      std::error_code error;
+      std::filesystem::remove(temp_path, error);
+    }
+    return file;
+#endif
+  }
+
+  static ConvexHullResult* Read(const std::string& path, uint64_t key) {
+#if _WIN32
+    // Read into a malloc block, destroyed with free.
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+      return nullptr;
+    }
+    ConvexHullCacheHeader header;
+    ConvexHullResult* result = nullptr;
+    std::error_code error;
+    if (fread(&header, sizeof(header), 1, file) == 1 && IsValid(header, key) &&
+        std::filesystem::file_size(path, error) == sizeof(header) + header.size && !error) {
+      result = static_cast<ConvexHullResult*>(malloc(header.size));
+      if (result == nullptr || fread(result, header.size, 1, file) != 1 || result->size != header.size ||
+          ConvexHullCacheChecksum(result, header.size) != header.checksum || !RelocateConvexHullResult(result)) {
+        free(result);
+        result = nullptr;
+      }
+    }
+    fclose(file);
+    return result;
+#else
+    // Map privately: relocating only copies the pages of the header and the
+    // hull table, vertices and indices are only read for the checksum and
+    // stay shared with the page cache.
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ConvexHullCacheHeader) + sizeof(ConvexHullResult)) {
+      close(fd);
+      return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive.
+    close(fd);
+    if (data == MAP_FAILED) {
+      return nullptr;
+    }
+    const ConvexHullCacheHeader* header = static_cast<const ConvexHullCacheHeader*>(data);
+    ConvexHullResult* result = reinterpret_cast<ConvexHullResult*>(static_cast<uint8_t*>(data) + sizeof(ConvexHullCacheHeader));
+    if (!IsValid(*header, key) || size != sizeof(ConvexHullCacheHeader) + header->size ||
+        result->size != header->size || ConvexHullCacheChecksum(result, header->size) != header->checksum ||
+        !RelocateConvexHullResult(result)) {
+      munmap(data, size);
+      return nullptr;
+    }
+    result->mapped = 1;
+    return result;
+#endif
+  }
+
+  static bool IsValid(const ConvexHullCacheHeader& header, uint64_t key) {
+    return header.magic == kConvexHullCacheMagic && header.version == kConvexHullCacheVersion &&
+           header.key == key && header.size >= sizeof(ConvexHullResult);
+  }
+
+  // Deletes the least recently used files until the directory fits in
+  // max_bytes_.
+  void Evict() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (directory_.empty() || max_bytes_ <= 0) {
+      return;
+    }
+    struct Entry {
+      std::filesystem::path path;
+      std::filesystem::file_time_type time;
+      uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    std::error_code error;
+    for (const auto& it : std::filesystem::directory_iterator(directory_, error)) {
+      if (it.path().extension() != ".vhacd") {
+        continue;
+      }
+      Entry entry = {it.path(), it.last_write_time(error), it.file_size(error)};
+      if (error) {
+        continue;
+      }
+      total += entry.size;
+      entries.push_back(entry);
+    }
+    if (total <= static_cast<uintmax_t>(max_bytes_)) {
+      return;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (const Entry& entry : entries) {
+      if (total <= static_cast<uintmax_t>(max_bytes_)) {
+        break;
+      }
+      // Results mapped by callers stay valid after the file is removed.
+      if (std::filesystem::remove(entry.path, error)) {
+        total -= entry.size;
+        evictions_++;
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::string directory_;
+  int64_t max_bytes_ = 0;
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  std::atomic<int64_t> evictions_{0};
 };
 
+FFI_PLUGIN_EXPORT void convex_hull_cache_configure(const char* directory, int64_t max_bytes) {
+  ConvexHullCache::Get().Configure(directory, max_bytes);
+}
+
+FFI_PLUGIN_EXPORT void convex_hull_cache_get_stats(ConvexHullCacheStats* stats) {
+  ConvexHullCache::Get().GetStats(stats);
+}
+
+FFI_PLUGIN_EXPORT void convex_hull_parameters_preset(int preset, ConvexHullParameters* parameters) {
+  VHACD::IVHACD::Parameters defaults;
+  parameters->max_convex_hulls = defaults.m_maxConvexHulls;
+  parameters->resolution = defaults.m_resolution;
+  parameters->max_vertices_per_hull = defaults.m_maxNumVerticesPerCH;
+  parameters->min_volume_percent_error = defaults.m_minimumVolumePercentErrorAllowed;
+  parameters->max_recursion_depth = defaults.m_maxRecursionDepth;
+  parameters->fill_mode = kConvexHullFillFlood;
+  parameters->async = defaults.m_asyncACD;
+  switch (preset) {
+    case kConvexHullPresetPreview:
+      parameters->max_convex_hulls = 8;
+      parameters->resolution = 10000;
+      parameters->max_vertices_per_hull = 16;
+      parameters->min_volume_percent_error = 10.0;
+      parameters->max_recursion_depth = 4;
+      break;
+    case kConvexHullPresetFast:
+      parameters->max_convex_hulls = 16;
+      parameters->resolution = 50000;
+      parameters->max_vertices_per_hull = 32;
+      parameters->min_volume_percent_error = 4.0;
+      parameters->max_recursion_depth = 6;
+      break;
+    case kConvexHullPresetHigh:
+      parameters->max_convex_hulls = 128;
+      parameters->resolution = 2000000;
+      parameters->max_vertices_per_hull = 128;
+      parameters->min_volume_percent_error = 0.1;
+      parameters->max_recursion_depth = 14;
+      break;
+    case kConvexHullPresetBalanced:
+    default:
+      break;
+  }
+}
+
+static VHACD::IVHACD::Parameters ToVHACDParameters(const ConvexHullParameters& in) {
+  VHACD::IVHACD::Parameters out;
+  out.m_maxConvexHulls = in.max_convex_hulls;
+  out.m_resolution = in.resolution;
+  out.m_maxNumVerticesPerCH = in.max_vertices_per_hull;
+  out.m_minimumVolumePercentErrorAllowed = in.min_volume_percent_error;
+  out.m_maxRecursionDepth = in.max_recursion_depth;
+  switch (in.fill_mode) {
+    case kConvexHullFillSurfaceOnly:
+      out.m_fillMode = VHACD::FillMode::SURFACE_ONLY;
+      break;
+    case kConvexHullFillRaycast:
+      out.m_fillMode = VHACD::FillMode::RAYCAST_FILL;
+      break;
+    default:
+      out.m_fillMode = VHACD::FillMode::FLOOD_FILL;
+      break;
+  }
+  // With an executor set all decomposition work should stay on its pool, so
+  // V-HACD does not get to start ACD threads of its own.
+  out.m_asyncACD = in.async && Executor().load() == nullptr;
+  return out;
+}
+
+FFI_PLUGIN_EXPORT ConvexHullResult* compute_convex_hull_with_parameters(const float* const points,
+                                                                        const uint32_t countPoints,
+                                                                        const uint32_t* const triangles,
+                                                                        const uint32_t countTriangles,
+                                                                        const ConvexHullParameters* parameters) {
+  ConvexHullCache& cache = ConvexHullCache::Get();
+  uint64_t key = ConvexHullCacheKey(points, countPoints, triangles, countTriangles, *parameters);
+  if (ConvexHullResult* cached = cache.Load(key)) {
+    return cached;
+  }
+  PooledVHACD vhacd;
+  ConvexHullResult* result = ComputeConvexHullResult(vhacd.get(), points, countPoints, triangles, countTriangles, ToVHACDParameters(*parameters));
+  if (result == nullptr) {
+    // V-HACD gives up on some degenerate inputs, report no hulls.
+    return PackConvexHullResult({});
+  }
+  cache.Store(key, result);
+  return result;
+}
+
 FFI_PLUGIN_EXPORT ConvexHullResult* compute_convex_hull(const float* const points,
                                                         const uint32_t countPoints,
                                                         const uint32_t* const triangles,
                                                         const uint32_t countTriangles) {
-  ConvexHullResult* result = new ConvexHullResult();
-  // TODO(johnmccutchan): Expose some parameters.
-  VHACD::IVHACD::Parameters params;
-  bool r = result->Compute(points, countPoints, triangles, countTriangles, params);
-  assert(r);
-  return result;
+  ConvexHullParameters parameters;
+  convex_hull_parameters_preset(kConvexHullPresetBalanced, &parameters);
+  return compute_convex_hull_with_parameters(points, countPoints, triangles, countTriangles, &parameters);
+}
+
+FFI_PLUGIN_EXPORT ConvexHullResult* compute_single_convex_hull(const float* const points,
+                                                               const uint32_t countPoints,
+                                                               const uint32_t max_vertices) {
+  std::vector<VHACD::Vertex> vertices;
+  vertices.reserve(countPoints);
+  for (uint32_t i = 0; i < countPoints; i++) {
+    vertices.emplace_back(points[i * 3 + 0], points[i * 3 + 1], points[i * 3 + 2]);
+  }
+  VHACD::QuickHull quickhull;
+  quickhull.ComputeConvexHull(vertices, max_vertices > 0 ? max_vertices : countPoints);
+  VHACD::IVHACD::ConvexHull hull;
+  hull.m_points = quickhull.GetVertices();
+  hull.m_triangles = quickhull.GetIndices();
+  if (hull.m_points.empty() || hull.m_triangles.empty()) {
+    return PackConvexHullResult({});
+  }
+  double min[3] = {DBL_MAX, DBL_MAX, DBL_MAX};
+  double max[3] = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
+  double sum[3] = {0.0, 0.0, 0.0};
+  for (const auto& point : hull.m_points) {
+    double p[3] = {point.mX, point.mY, point.mZ};
+    for (int j = 0; j < 3; j++) {
+      min[j] = std::min(min[j], p[j]);
+      max[j] = std::max(max[j], p[j]);
+      sum[j] += p[j];
+    }
+  }
+  double n = static_cast<double>(hull.m_points.size());
+  hull.m_center = VHACD::Vect3(sum[0] / n, sum[1] / n, sum[2] / n);
+  hull.mBmin = VHACD::Vect3(min[0], min[1], min[2]);
+  hull.mBmax = VHACD::Vect3(max[0], max[1], max[2]);
+  // Sum of the signed volumes of the tetrahedra from the center to every
+  // triangle.
+  double volume = 0.0;
+  for (const auto& triangle : hull.m_triangles) {
+    const auto& a = hull.m_points[triangle.mI0];
+    const auto& b = hull.m_points[triangle.mI1];
+    const auto& c = hull.m_points[triangle.mI2];
+    double ax = a.mX - hull.m_center[0], ay = a.mY - hull.m_center[1], az = a.mZ - hull.m_center[2];
+    double bx = b.mX - hull.m_center[0], by = b.mY - hull.m_center[1], bz = b.mZ - hull.m_center[2];
+    double cx = c.mX - hull.m_center[0], cy = c.mY - hull.m_center[1], cz = c.mZ - hull.m_center[2];
+    volume += ax * (by * cz - bz * cy) - ay * (bx * cz - bz * cx) + az * (bx * cy - by * cx);
+  }
+  hull.m_volume = std::abs(volume) / 6.0;
+  hull.m_meshId = 0;
+  return PackConvexHullResult({hull});
+}
+
+FFI_PLUGIN_EXPORT void compute_convex_hull_batch(const ConvexHullMesh* meshes,
+                                                 int num_meshes,
+                                                 ConvexHullResult** results,
+                                                 ConvexHullBatchStats* stats) {
+  auto start = std::chrono::steady_clock::now();
+  ConvexHullParameters balanced;
+  convex_hull_parameters_preset(kConvexHullPresetBalanced, &balanced);
+  // Helpers may start after the batch returned, e.g. when the executor's
+  // workers are all busy, so what they check lives on the heap.
+  struct BatchState {
+    std::mutex mutex;
+    std::condition_variable helpers_done;
+    bool closed = false;
+    int running_helpers = 0;
+    int started_helpers = 0;
+    std::atomic<int> next{0};
+  };
+  auto state = std::make_shared<BatchState>();
+  auto work = [state, meshes, num_meshes, results, &balanced]() {
+    for (int i = state->next++; i < num_meshes; i = state->next++) {
+      const ConvexHullMesh& mesh = meshes[i];
+      results[i] = compute_convex_hull_with_parameters(mesh.points, mesh.num_points, mesh.triangles, mesh.num_triangles,
+                                                       mesh.parameters != nullptr ? mesh.parameters : &balanced);
+    }
+  };
+  int max_threads = std::max(1, std::min<int>(num_meshes, std::thread::hardware_concurrency()));
+  for (int i = 1; i < max_threads; i++) {
+    RunTask([state, work]() {
+      {
+        // Once the caller ran out of work the batch is over, and work would
+        // touch its stack, so late helpers leave without doing anything.
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->closed) {
+          return;
+        }
+        state->running_helpers++;
+        state->started_helpers++;
+      }
+      work();
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (--state->running_helpers == 0) {
+        state->helpers_done.notify_one();
+      }
+    });
+  }
+  // The calling thread works too instead of waiting idle, and only waits for
+  // helpers that have started, so the batch finishes even when it runs on the
+  // only worker of the executor its helpers are queued on.
+  work();
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->closed = true;
+  state->helpers_done.wait(lock, [&]() { return state->running_helpers == 0; });
+  int num_threads = 1 + state->started_helpers;
+  lock.unlock();
+  if (stats == nullptr) {
+    return;
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  uint64_t num_triangles = 0;
+  for (int i = 0; i < num_meshes; i++) {
+    num_triangles += meshes[i].num_triangles;
+  }
+  double seconds = std::max(elapsed.count(), 1e-9);
+  stats->num_threads = num_threads;
+  stats->elapsed_ms = elapsed.count() * 1000.0;
+  stats->meshes_per_second = num_meshes / seconds;
+  stats->triangles_per_second = num_triangles / seconds;
+}
+
+FFI_PLUGIN_EXPORT void compute_convex_hull_batch_async(const ConvexHullMesh* meshes,
+                                                       int num_meshes,
+                                                       ConvexHullResult** results,
+                                                       ConvexHullBatchStats* stats,
+                                                       Dart_Port_DL port,
+                                                       int64_t request_id) {
+  RunTask([=]() {
+    compute_convex_hull_batch(meshes, num_meshes, results, stats);
+    Dart_PostInteger_DL(port, request_id);
+  });
 }
 
 FFI_PLUGIN_EXPORT void destroy_convex_hull_result(ConvexHullResult* result) {
-  delete result;
+  DestroyConvexHullResult(result);
 }
 
 FFI_PLUGIN_EXPORT int convex_hull_result_get_num_convex_hulls(ConvexHullResult* result) {
-  return result->GetNumConvexHulls();
+  return result->num_hulls;
 }
 
 FFI_PLUGIN_EXPORT ConvexHull* convex_hull_result_get_convex_hull(ConvexHullResult* result, int index) {
-  return result->GetConvexHull(index);
-}
\ No newline at end of file
+  return &result->hulls[index];
+}
+
+static void PostJobMessage(Dart_Port_DL port, int64_t request_id, ConvexHullJobMessage type, int64_t value, bool* posted = nullptr) {
+  Dart_CObject id;
+  id.type = Dart_CObject_kInt64;
+  id.value.as_int64 = request_id;
+  Dart_CObject message_type;
+  message_type.type = Dart_CObject_kInt64;
+  message_type.value.as_int64 = type;
+  Dart_CObject message_value;
+  message_value.type = Dart_CObject_kInt64;
+  message_value.value.as_int64 = value;
+  Dart_CObject* values[] = {&id, &message_type, &message_value};
+  Dart_CObject message;
+  message.type = Dart_CObject_kArray;
+  message.value.as_array.length = 3;
+  message.value.as_array.values = values;
+  bool r = Dart_PostCObject_DL(port, &message);
+  if (posted != nullptr) {
+    *posted = r;
+  }
+}
+
+// A decomposition running as a task, see RunTask. Owned jointly by the task
+// and the Dart handle, whichever lets go last deletes it.
+class ConvexHullJob : public VHACD::IVHACD::IUserCallback {
+ public:
+  ConvexHullJob(const float* const points,
+                const uint32_t countPoints,
+                const uint32_t* const triangles,
+                const uint32_t countTriangles,
+                const ConvexHullParameters& parameters,
+                Dart_Port_DL port,
+                int64_t request_id)
+      : points_(points, points + countPoints * 3),
+        triangles_(triangles, triangles + countTriangles * 3),
+        parameters_(ToVHACDParameters(parameters)),
+        cache_key_(ConvexHullCacheKey(points, countPoints, triangles, countTriangles, parameters)),
+        port_(port),
+        request_id_(request_id) {}
+
+  void Start() {
+    RunTask([this]() { Run(); });
+  }
+
+  void Cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (finished_) {
+      // Too late, the result is already on its way.
+      return;
+    }
+    cancelled_ = true;
+    if (vhacd_ != nullptr) {
+      vhacd_->Cancel();
+    }
+  }
+
+  void Unref() {
+    if (refs_.fetch_sub(1) == 1) {
+      delete this;
+    }
+  }
+
+  // Called by V-HACD, possibly from several of its threads.
+  void Update(const double overallProgress,
+              const double stageProgress,
+              const char* const stage,
+              const char* operation) override {
+    // Only post whole percent changes.
+    int percent = static_cast<int>(overallProgress);
+    int last = last_percent_.load();
+    while (percent > last) {
+      if (last_percent_.compare_exchange_weak(last, percent)) {
+        PostJobMessage(port_, request_id_, kConvexHullJobProgress, percent);
+        break;
+      }
+    }
+  }
+
+ private:
+  void Run() {
+    ConvexHullCache& cache = ConvexHullCache::Get();
+    ConvexHullResult* result = cancelled_ ? nullptr : cache.Load(cache_key_);
+    bool computed = false;
+    bool cancelled = false;
+    if (result == nullptr) {
+      PooledVHACD vhacd;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        vhacd_ = vhacd.get();
+      }
+      if (!cancelled_) {
+        parameters_.m_callback = this;
+        result = ComputeConvexHullResult(vhacd.get(), points_.data(), points_.size() / 3, triangles_.data(), triangles_.size() / 3, parameters_);
+        computed = true;
+      }
+      cancelled = Finish();
+      if (cancelled) {
+        vhacd.Discard();
+      }
+    } else {
+      cancelled = Finish();
+    }
+    if (cancelled) {
+      DestroyConvexHullResult(result);
+      PostJobMessage(port_, request_id_, kConvexHullJobCancelled, 0);
+    } else {
+      if (computed && result != nullptr) {
+        cache.Store(cache_key_, result);
+      }
+      bool posted = false;
+      PostJobMessage(port_, request_id_, kConvexHullJobDone, reinterpret_cast<int64_t>(result), &posted);
+      if (!posted) {
+        // The port was closed, nobody will take ownership.
+        DestroyConvexHullResult(result);
+      }
+    }
+    Unref();
+  }
+
+  // Marks the job as done so that later Cancel calls are ignored. Returns
+  // whether it was cancelled before that.
+  bool Finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    vhacd_ = nullptr;
+    finished_ = true;
+    return cancelled_;
+  }
+
+  std::vector<float> points_;
+  std::vector<uint32_t> triangles_;
+  VHACD::IVHACD::Parameters parameters_;
+  uint64_t cache_key_;
+  Dart_Port_DL port_;
+  int64_t request_id_;
+  std::mutex mutex_;
+  VHACD::IVHACD* vhacd_ = nullptr;
+  // Guarded by mutex_, set once the outcome of the job is decided.
+  bool finished_ = false;
+  std::atomic<bool> cancelled_{false};
+  std::atomic<int> last_percent_{-1};
+  // The running task and the Dart handle.
+  std::atomic<int> refs_{2};
+};
+
+FFI_PLUGIN_EXPORT void convex_hull_set_executor(ConvexHullExecutor executor) {
+  Executor().store(executor);
+}
+
+FFI_PLUGIN_EXPORT ConvexHullJob* compute_convex_hull_async(const float* const points,
+                                                           const uint32_t countPoints,
+                                                           const uint32_t* const triangles,
+                                                           const uint32_t countTriangles,
+                                                           const ConvexHullParameters* parameters,
+                                                           Dart_Port_DL port,
+                                                           int64_t request_id) {
+  ConvexHullJob* job = new ConvexHullJob(points, countPoints, triangles, countTriangles, *parameters, port, request_id);
+  job->Start();
+  return job;
+}
+
+FFI_PLUGIN_EXPORT void convex_hull_job_cancel(ConvexHullJob* job) {
+  job->Cancel();
+}
+
+FFI_PLUGIN_EXPORT void destroy_convex_hull_job(ConvexHullJob* job) {
+  job->Unref();
+}
@@ -54,13 +54,185 @@ typedef struct ConvexHull {
   double volume;
 } ConvexHull;
 
-typedef class_type ConvexHullResult ConvexHullResult;
-
+typedef enum ConvexHullFillMode {
+  // Flood fill the voxels outside the mesh, everything else is interior.
+  kConvexHullFillFlood,
+  // Only voxelize the surface, for meshes that are not closed.
+  kConvexHullFillSurfaceOnly,
+  // Find interior voxels with raycasts, for meshes with small holes.
+  kConvexHullFillRaycast,
+} ConvexHullFillMode;
+
+typedef struct ConvexHullParameters {
+  // Upper bound on the number of convex hulls.
+  uint32_t max_convex_hulls;
+  // Number of voxels used to approximate the mesh.
+  uint32_t resolution;
+  // Upper bound on the vertices of each hull.
+  uint32_t max_vertices_per_hull;
+  // Stop splitting a hull once its volume is within this percentage of the
+  // voxels it covers.
+  double min_volume_percent_error;
+  // Upper bound on how often hulls are split.
+  uint32_t max_recursion_depth;
+  // ConvexHullFillMode.
+  int fill_mode;
+  // Split hulls on several threads.
+  bool async;
+} ConvexHullParameters;
+
+// Trade decomposition time for fidelity. kConvexHullPresetBalanced matches
+// the V-HACD defaults.
+typedef enum ConvexHullPreset {
+  kConvexHullPresetPreview,
+  kConvexHullPresetFast,
+  kConvexHullPresetBalanced,
+  kConvexHullPresetHigh,
+} ConvexHullPreset;
+
+// A decomposition packed into one allocation: this header, then the hulls
+// table, then the vertices of every hull back to back, then their indices.
+// The vertices and indices of each ConvexHull point into the shared arrays.
+typedef struct ConvexHullResult {
+  uint32_t num_hulls;
+  // Number of floats in vertices.
+  uint32_t vertices_size;
+  // Number of uint32_ts in indices.
+  uint32_t indices_size;
+  // Non-zero when the result is a mapped cache file instead of a malloc block.
+  uint32_t mapped;
+  // Bytes in the whole allocation.
+  uint64_t size;
+  ConvexHull* hulls;
+  float* vertices;
+  uint32_t* indices;
+} ConvexHullResult;
+
+typedef class_type ConvexHullJob ConvexHullJob;
+
+// One input of compute_convex_hull_batch.
+typedef struct ConvexHullMesh {
+  const float* points;
+  uint32_t num_points;
+  const uint32_t* triangles;
+  uint32_t num_triangles;
+  // Null uses kConvexHullPresetBalanced.
+  const ConvexHullParameters* parameters;
+} ConvexHullMesh;
+
+typedef struct ConvexHullBatchStats {
+  // Worker threads used, including the calling thread.
+  int num_threads;
+  double elapsed_ms;
+  double meshes_per_second;
+  double triangles_per_second;
+} ConvexHullBatchStats;
+
+typedef struct ConvexHullCacheStats {
+  // compute_convex_hull* calls answered from the cache.
+  int64_t hits;
+  // compute_convex_hull* calls that ran V-HACD and stored their result.
+  int64_t misses;
+  // Results deleted to stay under the size limit.
+  int64_t evictions;
+} ConvexHullCacheStats;
+
+typedef enum ConvexHullJobMessage {
+  // value is the overall progress in percent.
+  kConvexHullJobProgress,
+  // value is the ConvexHullResult* address, 0 if the decomposition failed.
+  // The receiver owns the result.
+  kConvexHullJobDone,
+  // value is 0.
+  kConvexHullJobCancelled,
+} ConvexHullJobMessage;
+
+// Unit of work handed to a ConvexHullExecutor.
+typedef void (*ConvexHullTask)(void* data);
+// Runs task(data) on some thread, eventually. Must not run it inline on the
+// calling thread.
+typedef void (*ConvexHullExecutor)(ConvexHullTask task, void* data);
+
+// Runs async jobs and the helpers of compute_convex_hull_batch on executor
+// instead of on threads of their own, e.g. job_system_run_task from the
+// physics plugin to share its worker pool. Null, the default, starts a thread
+// per task. While an executor is set ConvexHullParameters.async is ignored and
+// V-HACD starts no threads of its own. Only affects work started afterwards.
+FFI_PLUGIN_EXPORT void convex_hull_set_executor(ConvexHullExecutor executor);
+
+// Builds one convex hull around points with quickhull, skipping voxelization
+// and decomposition. The hull keeps at most max_vertices of the points, 0
+// for no limit. Returns a result with a single hull, or no hull if the
+// points are degenerate.
+FFI_PLUGIN_EXPORT ConvexHullResult* compute_single_convex_hull(const float* const points,
+                                                               const uint32_t countPoints,
+                                                               const uint32_t max_vertices);
+
+// Stores decompositions in directory, keyed by a hash of the points,
+// triangles and parameters, so that later compute_convex_hull* calls with
+// the same input map the stored result instead of running V-HACD. When the
+// directory grows past max_bytes the least recently used results are
+// deleted. A null directory turns the cache off, which is the default.
+FFI_PLUGIN_EXPORT void convex_hull_cache_configure(const char* directory, int64_t max_bytes);
+
+FFI_PLUGIN_EXPORT void convex_hull_cache_get_stats(ConvexHullCacheStats* stats);
+
+// Fills parameters with a ConvexHullPreset.
+FFI_PLUGIN_EXPORT void convex_hull_parameters_preset(int preset, ConvexHullParameters* parameters);
+
+// Safe to call from several threads or isolates at once, each call uses its
+// own V-HACD instance from a pool.
 FFI_PLUGIN_EXPORT ConvexHullResult* compute_convex_hull(const float* const points,
                                     const uint32_t countPoints,
                                     const uint32_t* const triangles,
                                     const uint32_t countTriangles);
 
+FFI_PLUGIN_EXPORT ConvexHullResult* compute_convex_hull_with_parameters(const float* const points,
+                                                                        const uint32_t countPoints,
+                                                                        const uint32_t* const triangles,
+                                                                        const uint32_t countTriangles,
+                                                                        const ConvexHullParameters* parameters);
+
+// Decomposes num_meshes meshes in parallel on up to one thread per core and
+// stores one result per mesh in results, each destroyed separately with
+// destroy_convex_hull_result. Blocks until all are done. stats may be null.
+// Meshes run side by side, so parameters with async off usually scale
+// better than splitting every mesh on several threads as well.
+FFI_PLUGIN_EXPORT void compute_convex_hull_batch(const ConvexHullMesh* meshes,
+                                                 int num_meshes,
+                                                 ConvexHullResult** results,
+                                                 ConvexHullBatchStats* stats);
+
+// Runs compute_convex_hull_batch in the background and posts request_id to
+// port once every result is stored. meshes, their buffers, results and stats
+// must stay valid until then. Use this from an isolate that must not block
+// for the length of a large import.
+FFI_PLUGIN_EXPORT void compute_convex_hull_batch_async(const ConvexHullMesh* meshes,
+                                                       int num_meshes,
+                                                       ConvexHullResult** results,
+                                                       ConvexHullBatchStats* stats,
+                                                       Dart_Port_DL port,
+                                                       int64_t request_id);
+
+// Runs compute_convex_hull on a background thread. The input is copied before
+// returning. Messages are posted to port as lists of three integers
+// [request_id, ConvexHullJobMessage, value]. The last message is always
+// kConvexHullJobDone or kConvexHullJobCancelled.
+FFI_PLUGIN_EXPORT ConvexHullJob* compute_convex_hull_async(const float* const points,
+                                                           const uint32_t countPoints,
+                                                           const uint32_t* const triangles,
+                                                           const uint32_t countTriangles,
+                                                           const ConvexHullParameters* parameters,
+                                                           Dart_Port_DL port,
+                                                           int64_t request_id);
+
+// Asks V-HACD to stop at its next check. Does nothing once the job is done.
+FFI_PLUGIN_EXPORT void convex_hull_job_cancel(ConvexHullJob* job);
+
+// Releases the handle, a running job keeps going until done or cancelled.
+FFI_PLUGIN_EXPORT void destroy_convex_hull_job(ConvexHullJob* job);
+
+// Frees the whole result with a single free().
 FFI_PLUGIN_EXPORT void destroy_convex_hull_result(ConvexHullResult* result);
 
 FFI_PLUGIN_EXPORT int convex_hull_result_get_num_convex_hulls(ConvexHullResult* result);
@@ -1,5 +1,8 @@
+import 'package:cabal/physics/physics.dart';
 import 'package:cabal/util/convex_decomposition.dart';
 import 'package:vector_math/vector_math.dart';
+import 'dart:ffi' as ffi;
+import 'dart:io';
 import 'dart:typed_data';
 import 'package:test/test.dart';
 import 'dart:math';
@@ -27,6 +30,150 @@ main() {
       // Haven't verified the output yet:
       expect(ch.numVertices, equals(7));
       expect(ch.numTriangles, equals(10));
+      // A single hull is the whole shared vertex and index data.
+      expect(chd.vertexData, equals(ch.vertexData));
+      expect(chd.indexData, equals(ch.indexData));
+    });
+
+    test('presets', () {
+      final preview =
+          ConvexDecompositionParameters(ConvexDecompositionPreset.preview);
+      final high =
+          ConvexDecompositionParameters(ConvexDecompositionPreset.high);
+      expect(preview.resolution, lessThan(high.resolution));
+      expect(preview.maxConvexHulls, lessThan(high.maxConvexHulls));
+      final chd = ConvexHullDecomposition(
+          Float32List.fromList([1, 0, 1, 1, 0, 0, 0, 0, 0]),
+          Uint32List.fromList([0, 1, 2]),
+          preview);
+      expect(chd.length, equals(1));
+    });
+
+    test('cache', () {
+      final directory = Directory.systemTemp.createTempSync('vhacd_cache');
+      configureConvexDecompositionCache(directory.path);
+      final vertices = Float32List.fromList([1, 0, 1, 1, 0, 0, 0, 0, 0]);
+      final indices = Uint32List.fromList([0, 1, 2]);
+      final before = convexDecompositionCacheStats();
+      final computed = ConvexHullDecomposition(vertices, indices);
+      final cached = ConvexHullDecomposition(vertices, indices);
+      final after = convexDecompositionCacheStats();
+      configureConvexDecompositionCache(null);
+      directory.deleteSync(recursive: true);
+      expect(after.misses - before.misses, equals(1));
+      expect(after.hits - before.hits, equals(1));
+      expect(cached.length, equals(computed.length));
+      expect(cached.vertexData, equals(computed.vertexData));
+      expect(cached.indexData, equals(computed.indexData));
+    });
+
+    test('single hull', () {
+      // The corners of a cube plus its center.
+      final chd = ConvexHullDecomposition.singleHull(
+          Float32List.fromList([
+            0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 1, 0, //
+            0, 0, 1, 1, 0, 1, 0, 1, 1, 1, 1, 1,
+            0.5, 0.5, 0.5,
+          ]),
+          maxVertices: 8);
+      expect(chd.length, equals(1));
+      expect(chd[0].numVertices, lessThanOrEqualTo(8));
+      expect(chd[0].numTriangles, greaterThanOrEqualTo(4));
+    });
+
+    test('batch', () {
+      final mesh = ConvexDecompositionMesh(
+          Float32List.fromList([1, 0, 1, 1, 0, 0, 0, 0, 0]),
+          Uint32List.fromList([0, 1, 2]));
+      final batch = ConvexDecompositionBatch(List.filled(4, mesh));
+      expect(batch.results.length, equals(4));
+      for (final chd in batch.results) {
+        expect(chd.length, equals(1));
+      }
+      expect(batch.threads, greaterThan(0));
+      expect(batch.meshesPerSecond, greaterThan(0));
+    });
+
+    test('batch async', () async {
+      final mesh = ConvexDecompositionMesh(
+          Float32List.fromList([1, 0, 1, 1, 0, 0, 0, 0, 0]),
+          Uint32List.fromList([0, 1, 2]));
+      final batch =
+          await ConvexDecompositionBatch.computeAsync(List.filled(4, mesh));
+      expect(batch.results.length, equals(4));
+      for (final chd in batch.results) {
+        expect(chd.length, equals(1));
+      }
+    });
+
+    test('batch on the shared job system', () async {
+      // A single worker runs the batch itself, so its helpers queued on the
+      // same pool never start and the batch must not wait for them. The pool
+      // size only applies if nothing in this process started it yet, the
+      // batch has to finish either way.
+      configureJobSystem(threads: 1);
+      setConvexDecompositionExecutor(jobSystemExecutor);
+      addTearDown(() => setConvexDecompositionExecutor(ffi.nullptr));
+      final mesh = ConvexDecompositionMesh(
+          Float32List.fromList([1, 0, 1, 1, 0, 0, 0, 0, 0]),
+          Uint32List.fromList([0, 1, 2]));
+      final batch =
+          await ConvexDecompositionBatch.computeAsync(List.filled(4, mesh));
+      expect(batch.results.length, equals(4));
+      for (final chd in batch.results) {
+        expect(chd.length, equals(1));
+      }
+      final job = ConvexHullDecompositionJob.start(
+          Float32List.fromList([1, 0, 1, 1, 0, 0, 0, 0, 0]),
+          Uint32List.fromList([0, 1, 2]));
+      expect((await job.result).length, equals(1));
+    });
+
+    test('async', () async {
+      final progress = <int>[];
+      final job = ConvexHullDecompositionJob.start(
+          Float32List.fromList([1, 0, 1, 1, 0, 0, 0, 0, 0]),
+          Uint32List.fromList([0, 1, 2]),
+          onProgress: progress.add);
+      final chd = await job.result;
+      expect(chd.length, equals(1));
+      expect(chd[0].numVertices, equals(7));
+      expect(progress, isNotEmpty);
+      expect(progress.every((int percent) => percent <= 100), isTrue);
+      // Cancelling a finished job does nothing.
+      job.cancel();
+    });
+
+    test('cancel', () async {
+      // A UV sphere, large enough that the decomposition is still running
+      // when the cancel arrives.
+      const rings = 32;
+      const segments = 64;
+      final vertices = Float32List(3 * (rings + 1) * segments);
+      for (int r = 0; r <= rings; r++) {
+        final theta = pi * r / rings;
+        for (int s = 0; s < segments; s++) {
+          final phi = 2 * pi * s / segments;
+          final i = 3 * (r * segments + s);
+          vertices[i + 0] = sin(theta) * cos(phi);
+          vertices[i + 1] = cos(theta);
+          vertices[i + 2] = sin(theta) * sin(phi);
+        }
+      }
+      final indices = <int>[];
+      for (int r = 0; r < rings; r++) {
+        for (int s = 0; s < segments; s++) {
+          final a = r * segments + s;
+          final b = r * segments + (s + 1) % segments;
+          indices.addAll([a, b, a + segments, b, b + segments, a + segments]);
+        }
+      }
+      final job = ConvexHullDecompositionJob.start(
+          vertices, Uint32List.fromList(indices),
+          parameters:
+              ConvexDecompositionParameters(ConvexDecompositionPreset.high));
+      job.cancel();
+      await expectLater(job.result, throwsStateError);
     });
   });
 }
@@ -4,6 +4,7 @@ import 'package:vector_math/vector_math.dart';
 import 'dart:typed_data';
 import 'package:test/test.dart';
 import 'dart:math';
+import 'dart:io';
 
 main() {
   // Create a physics world. Gravity is -Y.
@@ -56,6 +57,149 @@ main() {
     expect(ball.position.y, lessThan(10));
   });
 
+  test('sync active transforms', () {
+    var sphere = SphereShape(SphereShapeSettings(1));
+    var ball = world.createRigidBody(BodySettings(sphere)
+      ..position = Vector3(0, 10, 0)
+      ..motionType = MotionType.dynamic);
+    world.addBody(ball);
+    world.step(dt);
+    world.syncActiveTransforms();
+    expect(ball.syncedWorldTransform, equals(ball.worldTransform));
+    expect(ball.syncedWorldTransform.getTranslation().y, lessThan(10));
+  });
+
+  test('transform mirror', () {
+    final mirror = world.enableTransformMirror(capacity: 16, matrices: true);
+    var sphere = SphereShape(SphereShapeSettings(1));
+    var ball = world.createRigidBody(BodySettings(sphere)
+      ..position = Vector3(0, 10, 0)
+      ..motionType = MotionType.dynamic);
+    world.addBody(ball);
+    expect(mirror.contains(ball), isTrue);
+    expect(mirror.position(ball), equals(Vector3(0, 10, 0)));
+    final generation = mirror.generation;
+    world.step(dt);
+    expect(mirror.generation, equals(generation + 1));
+    expect(mirror.position(ball), equals(ball.position));
+    expect(mirror.matrix(ball), equals(ball.worldTransform));
+    world.removeBody(ball);
+    expect(mirror.contains(ball), isFalse);
+  });
+
+  test('batched bodies', () {
+    var unitCube = BoxShape(BoxShapeSettings(Vector3(0.5, 0.5, 0.5)));
+    final boxes = world.createRigidBodies(List<BodySettings>.generate(
+        10,
+        (i) => BodySettings(unitCube)
+          ..position = Vector3(0, i * 2.0, 0)
+          ..motionType = MotionType.dynamic));
+    expect(boxes.length, equals(10));
+    expect(boxes[3].position, equals(Vector3(0, 6, 0)));
+    world.addBodies(boxes);
+    for (final box in boxes) {
+      expect(box.active, isTrue);
+    }
+    final ball = world.createRigidBody(
+        BodySettings(SphereShape(SphereShapeSettings(1)))
+          ..motionType = MotionType.dynamic);
+    final removed = world.createRigidBody(
+        BodySettings(SphereShape(SphereShapeSettings(1)))
+          ..motionType = MotionType.dynamic);
+    world.batchAdd(() {
+      world.addBody(ball);
+      world.addBody(removed);
+      expect(ball.active, isFalse);
+      // Removing a queued body drops it from the batch.
+      world.removeBody(removed);
+    });
+    expect(ball.active, isTrue);
+    expect(removed.active, isFalse);
+  });
+
+  test('world settings', () {
+    final small = World(WorldSettings()
+      ..maxBodies = 16
+      ..maxBodyPairs = 16
+      ..maxContactConstraints = 16
+      ..tempAllocatorSize = 64 * 1024
+      ..numThreads = 0
+      ..gravity = Vector3(0, 10, 0)
+      ..numBroadPhaseLayers = 1);
+    var sphere = SphereShape(SphereShapeSettings(1));
+    var ball = small.createRigidBody(BodySettings(sphere)
+      ..motionType = MotionType.dynamic);
+    small.addBody(ball);
+    small.step(dt);
+    // Gravity points up.
+    expect(ball.position.y, greaterThan(0));
+  });
+
+  test('fixed time step', () {
+    world.stepSettings = StepSettings()
+      ..fixedTimeStep = dt
+      ..maxSubsteps = 2;
+    final mirror = world.enableTransformMirror(capacity: 16);
+    var sphere = SphereShape(SphereShapeSettings(1));
+    var ball = world.createRigidBody(BodySettings(sphere)
+      ..position = Vector3(0, 10, 0)
+      ..motionType = MotionType.dynamic);
+    world.addBody(ball);
+    final generation = mirror.generation;
+    // Less than a step doesn't advance the simulation.
+    world.step(dt * 0.5);
+    expect(ball.position.y, equals(10));
+    expect(world.interpolationAlpha, closeTo(0.5, 1e-5));
+    // Crossing the step boundary runs one update.
+    world.step(dt * 0.75);
+    expect(mirror.generation, equals(generation + 1));
+    expect(world.interpolationAlpha, closeTo(0.25, 1e-5));
+    // Falling far behind is capped at maxSubsteps.
+    world.step(dt * 10);
+    expect(mirror.generation, equals(generation + 3));
+    expect(ball.position.y, lessThan(10));
+  });
+
+  test('async step', () async {
+    var sphere = SphereShape(SphereShapeSettings(1));
+    var ball = world.createRigidBody(BodySettings(sphere)
+      ..position = Vector3(0, 10, 0)
+      ..motionType = MotionType.dynamic);
+    world.addBody(ball);
+    final step = world.stepAsync(dt);
+    // The step may already be done, only check while it runs.
+    if (world.isStepping) {
+      expect(() => world.removeBody(ball), throwsStateError);
+      expect(() => world.syncActiveTransforms(), throwsStateError);
+    }
+    await step;
+    expect(world.isStepping, isFalse);
+    expect(ball.position.y, lessThan(10));
+    // Allowed again once the step is done.
+    world.syncActiveTransforms();
+    world.removeBody(ball);
+  });
+
+  test('interpolate during async step', () async {
+    final mirror = world.enableTransformMirror(capacity: 16);
+    var sphere = SphereShape(SphereShapeSettings(1));
+    var ball = world.createRigidBody(BodySettings(sphere)
+      ..position = Vector3(0, 10, 0)
+      ..motionType = MotionType.dynamic);
+    world.addBody(ball);
+    world.step(dt);
+    world.step(dt);
+    final generation = mirror.generation;
+    final before = mirror.interpolatedMatrix(ball, 0.5);
+    final step = world.stepAsync(dt);
+    // The step in flight writes neither of the interpolated buffers.
+    expect(mirror.generation, equals(generation));
+    expect(mirror.interpolatedMatrix(ball, 0.5), equals(before));
+    await step;
+    expect(mirror.generation, equals(generation + 1));
+    expect(mirror.position(ball), equals(ball.position));
+  });
+
   test('body settles', () {
     var unitCube = BoxShape(BoxShapeSettings(Vector3(0.5, 0.5, 0.5)));
     var box = world.createRigidBody(BodySettings(unitCube)
@@ -154,6 +298,185 @@ main() {
     expect(triangleMesh.localBounds.max, equals(Vector3(1, 1, 0)));
   });
 
+  test('shape binary', () {
+    var triangleMesh = MeshShape(MeshShapeSettings(
+        Float32List.fromList([0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0]),
+        Uint32List.fromList([0, 1, 2, 0, 2, 3])));
+    var compoundShape = CompoundShape(CompoundShapeSettings()
+      ..addShape(triangleMesh, Vector3(0.0, 0.0, 0.0), Quaternion.identity())
+      ..addShape(triangleMesh, Vector3(0.0, 2.0, 0.0), Quaternion.identity()));
+    final data = compoundShape.saveBinary();
+    final restored = Shape.restoreBinary(data);
+    expect(restored.localBounds.min, equals(Vector3(0, 0, 0)));
+    expect(restored.localBounds.max, equals(Vector3(1, 3, 0)));
+    // The shared mesh is written once.
+    expect(data.length, lessThan(triangleMesh.saveBinary().length * 2));
+    expect(() => Shape.restoreBinary(Uint8List(8)), throwsArgumentError);
+  });
+
+  test('shape bundle', () {
+    final dir = Directory.systemTemp.createTempSync('shape_bundle');
+    final path = '${dir.path}/shapes.bin';
+    var triangleMesh = MeshShape(MeshShapeSettings(
+        Float32List.fromList([0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0]),
+        Uint32List.fromList([0, 1, 2, 0, 2, 3])));
+    ShapeBundle.write(path, {
+      'mesh': triangleMesh,
+      'box': BoxShape(BoxShapeSettings(Vector3(1, 2, 3))),
+    });
+    final bundle = ShapeBundle.open(path);
+    expect(bundle.stats.shapes, equals(2));
+    expect(bundle.stats.restoredShapes, equals(0));
+    final box = bundle['box']!;
+    expect(box.localBounds.max, equals(Vector3(1, 2, 3)));
+    expect(bundle.stats.restoredShapes, equals(1));
+    // Later lookups return the restored shape.
+    expect(identical(bundle['box'], box), isTrue);
+    expect(bundle['missing'], isNull);
+    expect(bundle.shapeAt(bundle.find('mesh')).localBounds.max,
+        equals(Vector3(1, 1, 0)));
+    bundle.close();
+    expect(box.localBounds.min, equals(Vector3(-1, -2, -3)));
+    dir.deleteSync(recursive: true);
+  });
+
+  test('async shapes', () async {
+    final mesh = MeshShape.createAsync(MeshShapeSettings(
+        Float32List.fromList([0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0]),
+        Uint32List.fromList([0, 1, 2, 0, 2, 3])));
+    final hull = ConvexHullShape.createAsync(ConvexHullShapeSettings(
+        Float32List.fromList(
+            [-1, -1, -1, 1, -1, -1, -1, 1, -1, -1, -1, 1, 1, 1, 1])));
+    final shapes = await Future.wait([mesh, hull]);
+    expect(shapes[0].localBounds.max, equals(Vector3(1, 1, 0)));
+    expect(shapes[1].localBounds.max.x, closeTo(1, 0.1));
+    final compound = await CompoundShape.createAsync(CompoundShapeSettings()
+      ..addShape(shapes[1], Vector3(0, 2, 0), Quaternion.identity()));
+    expect(compound.localBounds.max.y, closeTo(3, 0.1));
+  });
+
+  test('shared job system', () {
+    // The world from setUp already started the pool, which is not resized
+    // under running jobs.
+    expect(configureJobSystem(threads: 2, priority: JobSystemPriority.low),
+        isFalse);
+    final box = BoxShape(BoxShapeSettings(Vector3(1, 1, 1)));
+    RigidBody fallingBox(World w) {
+      final body = w.createRigidBody(BodySettings(box)
+        ..position = Vector3(0, 10, 0)
+        ..motionType = MotionType.dynamic);
+      w.addBody(body);
+      return body;
+    }
+
+    // Worker threads of the process, only countable on Linux.
+    int threadCount() => Directory('/proc/self/task').listSync().length;
+    // The first world starts the pool.
+    final worlds = [World()];
+    final bodies = [fallingBox(worlds.first)];
+    worlds.first.step(dt);
+    final threadsBefore = Platform.isLinux ? threadCount() : 0;
+    for (int i = 0; i < 8; i++) {
+      final w = World();
+      worlds.add(w);
+      bodies.add(fallingBox(w));
+    }
+    for (int i = 0; i < 10; i++) {
+      for (final w in worlds) {
+        w.step(dt);
+      }
+    }
+    for (final body in bodies) {
+      expect(body.position.y, lessThan(10));
+    }
+    if (Platform.isLinux) {
+      // Worlds with pools of their own would add at least a thread each.
+      expect(threadCount() - threadsBefore, lessThan(worlds.length - 1));
+    }
+  });
+
+  test('strided mesh', () {
+    // Position followed by a normal and a uv, as in the render geometry.
+    final vertices = Float32List(4 * 8);
+    final positions =
+        Float32List.fromList([0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0]);
+    for (int i = 0; i < 4; i++) {
+      vertices.setRange(i * 8, i * 8 + 3, positions, i * 3);
+    }
+    final settings = StridedMeshSettings(vertices.buffer, 32,
+        indices: Uint16List.fromList([0, 1, 2, 0, 2, 3]).buffer,
+        indexWidth: MeshIndexWidth.uint16);
+    final mesh = MeshShape.strided(settings);
+    expect(mesh.localBounds.max, equals(Vector3(1, 1, 0)));
+    final packed = MeshShape(
+        MeshShapeSettings(positions, Uint32List.fromList([0, 1, 2, 0, 2, 3])));
+    expect(identical(mesh, packed), isTrue);
+    // A stride of 0 means packed positions.
+    final unstrided = StridedMeshSettings(positions.buffer, 0,
+        indices: Uint32List.fromList([0, 1, 2, 0, 2, 3]).buffer);
+    expect(unstrided.vertexCount, equals(4));
+    expect(identical(MeshShape.strided(unstrided), mesh), isTrue);
+  });
+
+  // An L shaped prism, which no single convex hull fits well.
+  StridedMeshSettings lPrism() {
+    final vertices = Float32List.fromList([
+      0, 0, 0, 2, 0, 0, 2, 1, 0, 1, 1, 0, 1, 2, 0, 0, 2, 0, //
+      0, 0, 1, 2, 0, 1, 2, 1, 1, 1, 1, 1, 1, 2, 1, 0, 2, 1,
+    ]);
+    final indices = <int>[
+      0, 2, 1, 0, 3, 2, 0, 5, 4, 0, 4, 3, //
+      6, 7, 8, 6, 8, 9, 6, 10, 11, 6, 9, 10,
+    ];
+    for (int i = 0; i < 6; i++) {
+      final j = (i + 1) % 6;
+      indices.addAll([i, j, j + 6, i, j + 6, i + 6]);
+    }
+    return StridedMeshSettings(vertices.buffer, 12,
+        indices: Uint32List.fromList(indices).buffer);
+  }
+
+  test('decomposed shape', () {
+    final shape = CompoundShape.decompose(
+        lPrism(), DecompositionSettings()..maxConvexHulls = 4);
+    // A single hull would cover the bounds just as well.
+    expect(shape.numSubShapes, greaterThan(1));
+    expect(shape.localBounds.max.x, closeTo(2, 0.1));
+    expect(shape.localBounds.max.y, closeTo(2, 0.1));
+    expect(shape.localBounds.max.z, closeTo(1, 0.1));
+  });
+
+  test('decomposed shape async', () async {
+    final shape = await CompoundShape.decomposeAsync(
+        lPrism(), DecompositionSettings()..maxConvexHulls = 4);
+    expect(shape.numSubShapes, greaterThan(1));
+    expect(shape.localBounds.max.y, closeTo(2, 0.1));
+  });
+
+  test('simplified hull', () {
+    // Points on a unit sphere.
+    final points = Float32List(3 * 400);
+    for (int i = 0; i < 400; i++) {
+      final y = 1 - 2 * (i + 0.5) / 400;
+      final r = sqrt(1 - y * y);
+      final theta = i * 2.399963;
+      points[i * 3 + 0] = r * cos(theta);
+      points[i * 3 + 1] = y;
+      points[i * 3 + 2] = r * sin(theta);
+    }
+    final hull = ConvexHullShape.simplified(ConvexHullShapeSettings(points),
+        maxVertices: 16);
+    expect(hull.numPoints, inInclusiveRange(4, 16));
+    expect(hull.localBounds.max.y, lessThanOrEqualTo(1.1));
+    expect(hull.localBounds.max.y, greaterThan(0.5));
+    // 0 keeps every point on the hull. A spherical cap of 100 points stays
+    // below Jolt's own limit on hull points.
+    final full = ConvexHullShape.simplified(
+        ConvexHullShapeSettings(Float32List.sublistView(points, 0, 3 * 100)),
+        maxVertices: 0);
+    expect(full.numPoints, greaterThan(16));
+  });
+
   test('raycast', () {
     final plane = BoxShape(BoxShapeSettings(Vector3(100, 1, 100)));
     final ground = world
@@ -170,6 +493,150 @@ main() {
     expect(count, equals(1));
   });
 
+  test('lock free raycast', () {
+    final plane = BoxShape(BoxShapeSettings(Vector3(100, 1, 100)));
+    final ground = world
+        .createRigidBody(BodySettings(plane)..position = Vector3(0.0, 0.0, 0));
+    final box = world.createRigidBody(
+        BodySettings(plane)..position = Vector3(0.0, 4.0, 0));
+    world.addBody(ground);
+    world.addBody(box);
+    final hits = <RayHit>[];
+    rayCast(world, Vector3(0, 10, 0), Vector3(0, -10, 0), (RayHit hit) {
+      hits.add(hit);
+      return 1.0;
+    }, lockFree: true);
+    // Every hit is reported, closest first.
+    expect(hits.length, equals(2));
+    expect(identical(hits[0].body, box), isTrue);
+    expect(identical(hits[1].body, ground), isTrue);
+    expect(hits[1].normal, equals(Vector3(0, 1, 0)));
+  });
+
+  test('activation events', () {
+    final activation = world.enableActivationEvents();
+    final plane = BoxShape(BoxShapeSettings(Vector3(100, 1, 100)));
+    final ground = world.createRigidBody(BodySettings(plane)
+      ..position = Vector3(0, 0, 0)
+      ..motionType = MotionType.static);
+    var sphere = SphereShape(SphereShapeSettings(1));
+    var ball = world.createRigidBody(BodySettings(sphere)
+      ..position = Vector3(0, 2.5, 0)
+      ..motionType = MotionType.dynamic);
+    world.addBody(ground);
+    world.addBody(ball);
+    expect(activation.isActive(ball), isTrue);
+    expect(activation.isActive(ground), isFalse);
+    world.step(dt);
+    expect(activation.activated, contains(ball));
+    var steps = 0;
+    while (activation.isActive(ball) && steps < 200) {
+      world.step(dt);
+      steps++;
+    }
+    // The ball comes to rest on the ground and falls asleep.
+    expect(activation.isActive(ball), isFalse);
+    expect(activation.deactivated, contains(ball));
+    world.step(dt);
+    expect(activation.deactivated, isEmpty);
+  });
+
+  test('sensor events', () {
+    final events = world.enableSensorEvents();
+    final volume = BoxShape(BoxShapeSettings(Vector3(2, 1, 2)));
+    final sensor = world.createRigidBody(BodySettings(volume)
+      ..position = Vector3(0, 0, 0)
+      ..isSensor = true);
+    var sphere = SphereShape(SphereShapeSettings(0.5));
+    var ball = world.createRigidBody(BodySettings(sphere)
+      ..position = Vector3(0, 3, 0)
+      ..motionType = MotionType.dynamic);
+    world.addBody(sensor);
+    world.addBody(ball);
+    final seen = <SensorEventType>[];
+    for (int i = 0; i < 60; i++) {
+      world.step(dt);
+      for (int j = 0; j < events.length; j++) {
+        final event = events[j];
+        expect(identical(event.sensor, sensor), isTrue);
+        expect(identical(event.other, ball), isTrue);
+        seen.add(event.type);
+      }
+    }
+    // The ball falls through the sensor without colliding.
+    expect(seen, equals([SensorEventType.enter, SensorEventType.exit]));
+    expect(ball.position.y, lessThan(-1.5));
+  });
+
+  test('contact events', () {
+    final events = world.enableContactEvents(capacity: 16);
+    final plane = BoxShape(BoxShapeSettings(Vector3(100, 1, 100)));
+    final ground = world.createRigidBody(BodySettings(plane)
+      ..position = Vector3(0, 0, 0)
+      ..motionType = MotionType.static);
+    var sphere = SphereShape(SphereShapeSettings(1));
+    var ball = world.createRigidBody(BodySettings(sphere)
+      ..position = Vector3(0, 2.5, 0)
+      ..motionType = MotionType.dynamic);
+    world.addBody(ground);
+    world.addBody(ball);
+    ball.contactEvents = true;
+    var added = 0;
+    for (int i = 0; i < 60; i++) {
+      world.step(dt);
+      for (int j = 0; j < events.length; j++) {
+        final event = events[j];
+        if (event.type != ContactEventType.added) {
+          continue;
+        }
+        added++;
+        expect(identical(event.body1, ground) || identical(event.body2, ground),
+            isTrue);
+        expect(identical(event.body1, ball) || identical(event.body2, ball),
+            isTrue);
+      }
+    }
+    expect(added, greaterThan(0));
+    expect(events.dropped, equals(0));
+  });
+
+  test('raycast batch', () {
+    final plane = BoxShape(BoxShapeSettings(Vector3(100, 1, 100)));
+    final ground = world
+        .createRigidBody(BodySettings(plane)..position = Vector3(0.0, 0.0, 0));
+    world.addBody(ground);
+    final batch = RayCastBatch(4)
+      ..add(Vector3(0, 10, 0), Vector3(0, -10, 0))
+      ..add(Vector3(0, 10, 0), Vector3(0, 20, 0));
+    for (final mode in RayCastMode.values) {
+      batch.cast(world, mode: mode);
+      final hit = batch[0]!;
+      expect(identical(hit.body, ground), isTrue);
+      expect(hit.normal, equals(Vector3(0, 1, 0)));
+      expect(hit.point.y, closeTo(1.0, 1e-5));
+      expect(batch[1], isNull);
+    }
+    // Hits on a body removed after the cast are dropped.
+    world.removeBody(ground);
+    expect(batch[0], isNull);
+  });
+
+  test('shape cache', () {
+    final hits = shapeCacheStats().hits;
+    final a = BoxShape(BoxShapeSettings(Vector3(0.5, 0.5, 0.5)));
+    final b = BoxShape(BoxShapeSettings(Vector3(0.5, 0.5, 0.5)));
+    final c = BoxShape(BoxShapeSettings(Vector3(0.5, 1.0, 0.5)));
+    expect(identical(a, b), isTrue);
+    expect(identical(a, c), isFalse);
+    expect(shapeCacheStats().hits, equals(hits + 1));
+    // Decorated shapes are keyed by their inner shape.
+    final scaledA = ScaledShape(ScaledShapeSettings(a, Vector3(2, 2, 2)));
+    final scaledB = ScaledShape(ScaledShapeSettings(b, Vector3(2, 2, 2)));
+    final scaledC = ScaledShape(ScaledShapeSettings(c, Vector3(2, 2, 2)));
+    expect(identical(scaledA, scaledB), isTrue);
+    expect(identical(scaledA, scaledC), isFalse);
+  });
+
   test('scaled shape', () {
     var unitCube = BoxShape(BoxShapeSettings(Vector3(0.5, 0.5, 0.5)));
     var scaledCube =